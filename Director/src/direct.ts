@@ -4,38 +4,72 @@
  * Sits between the Player (canvas animation engine) and the Sender (C raw
  * Ethernet transmitter), coordinating frame production and Redis transport.
  *
- * The main loop calls player.play() to render one frame, pushes the RGBA
- * buffer to a Redis list, and applies back-pressure so the list doesn't
- * grow unbounded if the sender falls behind or is offline:
+ * The main loop calls player.play() to render one frame and pushes the RGBA
+ * buffer to a Redis list. Flow control is credit-based: the Sender acks
+ * every frame it takes off the queue with a token on sender:credits, and
+ * the Director keeps at most sender:queue_target frames in flight. It only
+ * renders while it holds credit, so the queue stays a few frames deep, no
+ * frame is rendered just to be thrown away, and latency stays flat. Each
+ * ack carries the time the frame's rows went out, giving the end-to-end
+ * latency from render start to the wire. The push, a cap on the queue and
+ * collecting waiting acks are one server-side script call per frame.
  *
- *   1. After rpush, check if the list length equals FPS (one second of
- *      buffered frames). If not, keep producing — the sender is consuming.
- *   2. If it does equal FPS, wait SENDER_WAIT_MS for the sender to drain.
- *   3. Re-check list length. If still FPS, the sender is stalled — flush
- *      the list and sleep PLAYER_BACKOFF_MS to avoid filling memory.
+ * Every frame is prefixed with a 32-byte header (Sender/src/frame.h): a
+ * frame ID and a presentation time on CLOCK_MONOTONIC. PTS advance by
+ * exactly one frame period, so the Sender shows each frame in its own
+ * slot regardless of render jitter; if rendering falls so far behind that
+ * the next PTS can no longer be met, the clock is re-anchored (a "slip").
+ * A movie with sign.fps below 240 and sign.interpolate set is rendered
+ * as keyframes only; the Sender blends the slots in between. With
+ * sign.wire set, frames carry packet-ready RGB rows (Player.getWireRows())
+ * that the Sender transmits without converting them. A frame identical to
+ * the one before goes out as a 40-byte repeat marker naming it. With
+ * RENDER_WORKERS set, frames are rendered ahead on worker threads
+ * (render.ts) and taken back in order. From its second cycle on, a movie
+ * is replayed from an in-memory cache of its deflated frames instead of
+ * rendered again (MOVIE_CACHE_MB).
  *
  * Data flow:
- *   Player.play() → RGBA buffer → Redis list (player:frames) → sender.c (BLPOP)
+ *   Player.play() → RGBA buffer → Redis list (player:frames) → sender.c (BLMPOP)
+ *                             or → Redis stream (player:stream) → sender.c (XREAD)
+ *   sender.c ack  → Redis list (sender:credits) → Director (BLPOP)
  *   Sensor daemon → Redis PUB (player:brightness:channel) → subscriber → player.brightness
  */
 
+import { createHash } from "crypto";
+import { readFileSync } from "fs";
 import path from "path";
+import { createHistogram } from "perf_hooks";
 import { fileURLToPath } from "url";
+import { GCProfiler, getHeapStatistics } from "v8";
+import { Worker } from "worker_threads";
+import { deflateRawSync, inflateRawSync } from "zlib";
 import { Canvas, FontLibrary } from "skia-canvas";
 import { Redis } from "ioredis";
+import type { Result } from "ioredis";
 import Player from "@myled/player";
 import type { Movie } from "@myled/player";
+import type { FromWorker, RenderSetup, ToWorker } from "./render.js";
 
 const __dirname = path.dirname(fileURLToPath(import.meta.url));
 
 // ── Constants ───────────────────────────────────────────────────────
 
 const FPS = 240;
-const PLAYER_BACKOFF_MS = 100;           /* Pause when sender is stalled */
 const PLAYER_FRAMES_KEY = "player:frames";
 const REDIS_PATH = "/var/run/redis/redis-server.sock";
-const SENDER_WAIT_MS = 5;               /* Grace period before re-checking list length */
+const DEFAULT_QUEUE_TARGET = 4;          /* Frames in flight until the Sender publishes its own */
+const CREDIT_WAIT_S = 1;                 /* Ack wait before resyncing with the queue */
+const STATS_INTERVAL_MS = 1000;          /* Flow report + queue target refresh */
 const ERROR_BACKOFF_MS = 1000;           /* Cooldown after an error in the main loop */
+const QUEUE_CAP = 60;                    /* Frames (250 ms at 240 FPS) kept queued at most, trimmed oldest first */
+const REPEAT_REFRESH_FRAMES = FPS;       /* Repeat markers in a row before the pixels go out again */
+const RENDER_WORKERS = Number(process.env.RENDER_WORKERS ?? 0); /* Render-ahead threads, 0 = render inline */
+const RENDER_CHUNK_FRAMES = 24;          /* Frames per range handed to a worker (100 ms at 240 FPS) */
+const RENDER_AHEAD_CHUNKS = 2;           /* Ranges queued per worker */
+const SENDER_CPU = 1;                    /* The Sender's core (Sender/start): never the Director's */
+const MOVIE_CACHE_MB = Number(process.env.MOVIE_CACHE_MB ?? 64); /* Compressed cycles kept, 0 = no cache */
+const BRIGHTNESS_BUCKET = 2;             /* Brightness steps rendered (and cached) with the cache on */
 
 // ── Helpers ─────────────────────────────────────────────────────────
 
@@ -46,6 +80,10 @@ const sleep = async (t: number): Promise<void> =>
 
 const BRIGHTNESS_CHANNEL = "player:brightness:channel";
 const BRIGHTNESS_KEY = "player:brightness";
+const SENDER_CREDITS_KEY = "sender:credits";
+const SENDER_QUEUE_TARGET_KEY = "sender:queue_target";
+const SENDER_TRANSPORT_KEY = "sender:transport";
+const PLAYER_STREAM_KEY = "player:stream";
 
 // ── Default movie ───────────────────────────────────────────────────
 // Fallback content shown when no movie has been pushed from the web
@@ -129,11 +167,633 @@ FontLibrary.use("Inter", [path.join(__dirname, "..", "fonts", "Inter.ttf")]);
 // ── Brightness ──────────────────────────────────────────────────────
 
 subscriber.on("message", (channel: string, message: string) => {
-  if (channel === BRIGHTNESS_CHANNEL) {
-    player.brightness = Number(message);
-  }
+  if (channel === BRIGHTNESS_CHANNEL) setBrightness(Number(message));
 });
 
+/**
+ * Render with brightness `level` from now on, on every worker too. With
+ * the movie cache on it is rounded to BRIGHTNESS_BUCKET, so a cached
+ * cycle is exactly what a live render would draw.
+ */
+const setBrightness = (level: number): void => {
+  player.brightness = MOVIE_CACHE_MB > 0
+    ? Math.max(BRIGHTNESS_BUCKET, Math.round(level / BRIGHTNESS_BUCKET) * BRIGHTNESS_BUCKET)
+    : level;
+  const msg: ToWorker = { type: "brightness", value: player.brightness };
+  workers.forEach((worker) => worker.postMessage(msg));
+  brightChunk = chunkNext;
+};
+
+// ── Flow control ────────────────────────────────────────────────────
+// Render-start times (wall clock, us) of frames pushed but not yet acked,
+// oldest first. Frames and acks are both FIFO, so each ack pairs with the
+// head of this list.
+
+const inFlight: number[] = [];
+let queueTarget = DEFAULT_QUEUE_TARGET;
+
+const flow = {
+  frames: 0,
+  creditWaits: 0,
+  dropped: 0,
+  trimmed: 0,
+  roundTrips: 0,
+  repeats: 0,
+  bytesSaved: 0,
+  renderSumMs: 0,
+  renderMaxMs: 0,
+  depthSum: 0,
+  latencySumUs: 0,
+  latencyMaxUs: 0,
+  samples: 0,
+};
+
+const nowUs = (): number => (performance.timeOrigin + performance.now()) * 1000;
+
+/**
+ * Retire the oldest in-flight frame. `token` is when the Sender sent it
+ * (us), or "drop" if its live policy skipped the frame.
+ */
+const ack = (token: string): void => {
+  const started = inFlight.shift();
+  if (started === undefined) return;
+  if (token === "drop") {
+    flow.dropped++;
+    haveLastPixels = false;
+    return;
+  }
+  const latencyUs = Number(token) - started;
+  flow.latencySumUs += latencyUs;
+  flow.latencyMaxUs = Math.max(flow.latencyMaxUs, latencyUs);
+  flow.samples++;
+};
+
+/**
+ * Block until an ack frees a credit (fewer than queueTarget frames in
+ * flight). Any further acks waiting behind it come back with the next push.
+ */
+const waitForCredit = async (): Promise<void> => {
+  while (inFlight.length >= queueTarget) {
+    flow.creditWaits++;
+    flow.roundTrips++;
+    const token = await redis.blpop(SENDER_CREDITS_KEY, CREDIT_WAIT_S);
+    if (token === null) {
+      /*
+       * No ack for a whole second: the Sender is down, or died holding
+       * popped frames it will never ack. Trust the queue itself — anything
+       * no longer in it has left for good.
+       */
+      const queued = await queueLength();
+      inFlight.splice(0, Math.max(0, inFlight.length - queued));
+      continue;
+    }
+    ack(token[1]);
+  }
+};
+
+/** Log the last interval's flow figures and pick up a changed queue_target or transport. */
+const reportFlow = async (intervalMs: number): Promise<void> => {
+  const avg = (sum: number, n: number): string => (n ? (sum / n / 1000).toFixed(2) : "-");
+  console.log(
+    `Flow: ${(flow.frames * 1000 / intervalMs).toFixed(1)} fps` +
+      ` | Depth: ${flow.frames ? (flow.depthSum / flow.frames).toFixed(1) : "-"}/${queueTarget}` +
+      ` | Latency: ${avg(flow.latencySumUs, flow.samples)} ms avg, ${(flow.latencyMaxUs / 1000).toFixed(2)} ms max` +
+      ` | Render: ${avg(flow.renderSumMs * 1000, flow.frames)} ms avg, ${flow.renderMaxMs.toFixed(2)} ms max` +
+      (workers.length ? ` | Ahead: ${renderedAhead()}` : "") +
+      (MOVIE_CACHE_MB > 0 ? ` | Cache: ${cacheState()}` : "") +
+      ` | Credit waits: ${flow.creditWaits}` +
+      ` | Round trips: ${flow.frames ? (flow.roundTrips / flow.frames).toFixed(2) : "-"}/frame` +
+      ` | Dropped: ${flow.dropped}` +
+      ` | Trimmed: ${flow.trimmed}` +
+      ` | Repeats: ${flow.repeats} (${(flow.bytesSaved / 1024).toFixed(0)} KB saved)` +
+      ` | Slips: ${slips}` +
+      ` | ${gcReport(flow.frames)}`,
+  );
+  slips = 0;
+  Object.assign(flow, { frames: 0, creditWaits: 0, dropped: 0, trimmed: 0, roundTrips: 0, repeats: 0, bytesSaved: 0, renderSumMs: 0, renderMaxMs: 0, depthSum: 0, latencySumUs: 0, latencyMaxUs: 0, samples: 0 });
+
+  const target = Number(await redis.get(SENDER_QUEUE_TARGET_KEY));
+  if (target > 0) queueTarget = target;
+  transport = (await redis.get(SENDER_TRANSPORT_KEY)) ?? "list";
+};
+
+// ── Transport ───────────────────────────────────────────────────────
+// The Sender publishes the queue it reads on sender:transport: the
+// player:frames list, or the player:stream stream. A stream entry's ID is
+// the frame's render start in ms ("<ms>-*" lets Redis number frames
+// started in the same millisecond), so the Sender knows how old every
+// frame is when it commits. The Sender trims entries as it consumes them.
+//
+// Every frame is queued by one script call (EVALSHA, falling back to EVAL
+// once after Redis restarts): push, trim the queue to QUEUE_CAP by
+// dropping its oldest frames, and take whatever acks are waiting on
+// sender:credits — one round trip where a push and a credit pop used to
+// be two. Credit flow keeps the queue far below the cap; the cap only
+// bounds it when the books are off (another Director, a Sender that came
+// back after a resync) instead of letting it grow unchecked.
+
+const PUSH_FRAME_LUA = `
+local n
+if ARGV[4] == '' then
+  n = redis.call('RPUSH', KEYS[1], ARGV[1])
+else
+  redis.call('XADD', KEYS[1], ARGV[4], 'frame', ARGV[1])
+  n = redis.call('XLEN', KEYS[1])
+end
+local cap = tonumber(ARGV[2])
+local trimmed = 0
+if n > cap then
+  trimmed = n - cap
+  if ARGV[4] == '' then
+    redis.call('LTRIM', KEYS[1], trimmed, -1)
+  else
+    redis.call('XTRIM', KEYS[1], 'MAXLEN', cap)
+  end
+end
+return {n, trimmed, redis.call('LPOP', KEYS[2], ARGV[3]) or {}}
+`;
+
+declare module "ioredis" {
+  interface RedisCommander<Context> {
+    /** PUSH_FRAME_LUA: [queue length before the trim, frames trimmed, credit tokens]. */
+    pushFrameCapped(
+      queueKey: string, creditsKey: string,
+      frame: Buffer, cap: number, maxCredits: number, streamId: string,
+    ): Result<[number, number, string[]], Context>;
+  }
+}
+
+redis.defineCommand("pushFrameCapped", { numberOfKeys: 2, lua: PUSH_FRAME_LUA });
+
+let transport = "list";
+let streamMs = 0;                        /* Last ID's ms: IDs must never go backwards */
+
+/** Frames waiting on the Sender's queue. */
+const queueLength = (): Promise<number> => {
+  flow.roundTrips++;
+  return transport === "stream" ? redis.xlen(PLAYER_STREAM_KEY) : redis.llen(PLAYER_FRAMES_KEY);
+};
+
+/**
+ * Queue one frame rendered at `renderStartedUs` (wall clock), retire the
+ * frames the cap trimmed and apply the acks that came back with it.
+ * Returns the queue length after the push.
+ */
+const pushFrame = async (frame: Buffer, renderStartedUs: number): Promise<number> => {
+  const stream = transport === "stream";
+  if (stream) streamMs = Math.max(streamMs, Math.floor(renderStartedUs / 1000));
+
+  flow.roundTrips++;
+  const [length, trimmed, tokens] = await redis.pushFrameCapped(
+    stream ? PLAYER_STREAM_KEY : PLAYER_FRAMES_KEY, SENDER_CREDITS_KEY,
+    frame, Math.max(QUEUE_CAP, queueTarget), queueTarget, stream ? `${streamMs}-*` : "",
+  );
+
+  /*
+   * The queue holds the last `length` frames in flight (this one included),
+   * behind any it holds that aren't ours; the cap took its oldest.
+   */
+  inFlight.push(renderStartedUs);
+  const queuedFrom = inFlight.length - length;
+  const ours = Math.max(0, queuedFrom + trimmed) - Math.max(0, queuedFrom);
+  inFlight.splice(Math.max(0, queuedFrom), ours);
+  flow.trimmed += ours;
+  if (trimmed) haveLastPixels = false;
+  tokens.forEach(ack);
+  return length - trimmed;
+};
+
+// ── Frame header ────────────────────────────────────────────────────
+// Mirrors frame_header_t in Sender/src/frame.h (little-endian, 32 bytes).
+
+const FRAME_MAGIC = 0x46503250;          /* "P2PF" */
+const FRAME_VERSION = 1;
+const FRAME_HEADER_SIZE = 32;
+const FRAME_FLAG_INTERPOLATE = 1 << 0;   /* Sender blends the slots up to the next frame */
+const FRAME_FLAG_WIRE = 1 << 1;          /* Packet-ready RGB rows instead of the canvas */
+const FRAME_FLAG_REPEAT = 1 << 2;        /* No pixels: the frame ID of an earlier frame to show again */
+
+const header = Buffer.alloc(FRAME_HEADER_SIZE);
+let frameId = 0n;
+let nextPts = 0n;                        /* CLOCK_MONOTONIC ns; 0n = not anchored yet */
+let period = 0n;                         /* Frame period (ns) of the loaded movie */
+let headerFlags = 0;                     /* Its FRAME_FLAG_INTERPOLATE | FRAME_FLAG_WIRE */
+let slips = 0;
+
+/** Take the frame period and flags from the movie just loaded. */
+const setHeaderMovie = (): void => {
+  const { fps, interpolate, wire } = player.movie!.sign;
+  period = BigInt(Math.round(1e9 / (fps ?? FPS)));
+  headerFlags = (interpolate ? FRAME_FLAG_INTERPOLATE : 0) | (wire ? FRAME_FLAG_WIRE : 0);
+};
+
+/** Fill `header` for the next frame and advance the frame ID and PTS. */
+const stampHeader = (width: number, height: number): Buffer => {
+  const now = process.hrtime.bigint();
+
+  /* Can't reach the Sender before its PTS: restart the clock behind what's in flight. */
+  if (nextPts < now + period) {
+    if (nextPts !== 0n) slips++;
+    nextPts = now + period * BigInt(queueTarget + 1);
+  }
+
+  frameId++;
+  header.writeUInt32LE(FRAME_MAGIC, 0);
+  header.writeUInt16LE(FRAME_VERSION, 4);
+  header.writeUInt16LE(FRAME_HEADER_SIZE, 6);
+  header.writeBigUInt64LE(frameId, 8);
+  header.writeBigInt64LE(nextPts, 16);
+  header.writeUInt16LE(width, 24);
+  header.writeUInt16LE(height, 26);
+  header.writeUInt32LE(headerFlags, 28);
+  nextPts += period;
+  return header;
+};
+
+// ── Repeat markers ──────────────────────────────────────────────────
+// A frame whose pixels match the last frame pushed (a hold) goes out as a
+// 40-byte marker naming that frame instead of the whole canvas (see
+// FRAME_FLAG_REPEAT in Sender/src/frame.h), and the Sender re-latches the
+// rows it already sent. Comparing against the last pixels is a memcmp,
+// cheaper than hashing them in JavaScript. The pixels go out again after
+// REPEAT_REFRESH_FRAMES markers and after any drop or trim, so a Sender
+// that never saw the frame a marker names (restarted, or skipped it to
+// catch up) is back in step within a second.
+
+const marker = Buffer.alloc(FRAME_HEADER_SIZE + 8);
+let lastPixels = Buffer.alloc(0);        /* Copy of the pixels markers name */
+let haveLastPixels = false;              /* false = send the next frame in full */
+let lastPixelsId = 0n;
+let repeatsInRow = 0;
+
+/*
+ * The full frame, rebuilt in place every frame. Reusing it is safe: the
+ * loop waits for each push's reply, so Redis has every byte of it before
+ * the next frame is built.
+ */
+let payload = Buffer.alloc(0);
+
+/** The payload for the frame just stamped: a repeat marker, or `header` + `pixels`. */
+const buildFrame = (header: Buffer, pixels: Buffer): Buffer => {
+  if (haveLastPixels && repeatsInRow < REPEAT_REFRESH_FRAMES && pixels.equals(lastPixels)) {
+    header.copy(marker);
+    marker.writeUInt32LE(header.readUInt32LE(28) | FRAME_FLAG_REPEAT, 28);
+    marker.writeBigUInt64LE(lastPixelsId, FRAME_HEADER_SIZE);
+    repeatsInRow++;
+    flow.repeats++;
+    flow.bytesSaved += FRAME_HEADER_SIZE + pixels.length - marker.length;
+    return marker;
+  }
+  /* Copies, not references: getWireRows() writes into the same buffer next frame. */
+  if (lastPixels.length !== pixels.length) lastPixels = Buffer.allocUnsafe(pixels.length);
+  pixels.copy(lastPixels);
+  haveLastPixels = true;
+  lastPixelsId = frameId;
+  repeatsInRow = 0;
+
+  if (payload.length !== FRAME_HEADER_SIZE + pixels.length) payload = Buffer.allocUnsafe(FRAME_HEADER_SIZE + pixels.length);
+  header.copy(payload);
+  pixels.copy(payload, FRAME_HEADER_SIZE);
+  return payload;
+};
+
+// ── Render-ahead ────────────────────────────────────────────────────
+// With RENDER_WORKERS > 0, frames are rendered ahead of need on worker
+// threads (render.ts), each with its own Canvas and Player. The movie
+// cycle is cut into ranges of RENDER_CHUNK_FRAMES, handed out round-robin
+// up to RENDER_AHEAD_CHUNKS per worker past the one being read, and read
+// back strictly in range order: the same frames in the same order as
+// rendering inline. A slow draw or a GC pause on the main thread now eats
+// into frames already rendered instead of the Sender's queue. Frames keep
+// the time they started rendering, so the flow line's latency still runs
+// from render start to the wire. A brightness change reaches the frames
+// not rendered yet, up to ~200 ms per worker later.
+//
+// The workers run on the CPUs the process is pinned to (DIRECTOR_CPUS in
+// ./start); the Director won't start them on the Sender's core.
+
+interface Rendered {
+  pixels: Buffer;
+  index: number;                         /* Frame of the movie cycle */
+  renderStartedUs: number;               /* Wall clock */
+  renderMs: number;
+}
+
+const workers: Worker[] = [];
+const chunks = new Map<number, { frames: Rendered[]; done: boolean }>();
+let chunkNext = 0;                       /* Next range to hand out */
+let chunkRead = 0;                       /* Range frames are read from */
+let wake: (() => void) | null = null;    /* renderFrame() waiting on a worker */
+let resumeChunk = -1;                    /* Range rendering resumed in (see resumeRendering()) ... */
+let resumeIndex = 0;                     /* ... and the first frame of it wanted */
+let brightChunk = 0;                     /* First range rendered at the current brightness */
+
+/** CPUs this process may run on (its taskset), from /proc/self/status. */
+const allowedCpus = (): number[] => {
+  const list = /Cpus_allowed_list:\s*(\S+)/.exec(readFileSync("/proc/self/status", "utf8"))?.[1] ?? "";
+  return list.split(",").flatMap((span) => {
+    const [lo, hi = lo] = span.split("-").map(Number);
+    return Array.from({ length: hi - lo + 1 }, (_, i) => lo + i);
+  });
+};
+
+/** Frames [start, end) of the movie cycle in range `chunk`. */
+const chunkRange = (chunk: number): { start: number; end: number } => {
+  const perCycle = Math.ceil(player.frames / RENDER_CHUNK_FRAMES) || 1;
+  const start = (chunk % perCycle) * RENDER_CHUNK_FRAMES;
+  return { start, end: Math.min(start + RENDER_CHUNK_FRAMES, player.frames) };
+};
+
+/** Keep every worker RENDER_AHEAD_CHUNKS ranges ahead of the reader. */
+const dispatch = (): void => {
+  while (chunkNext < chunkRead + workers.length * RENDER_AHEAD_CHUNKS) {
+    const chunk = chunkNext++;
+    chunks.set(chunk, { frames: [], done: false });
+    const msg: ToWorker = { type: "render", chunk, ...chunkRange(chunk) };
+    workers[chunk % workers.length].postMessage(msg);
+  }
+};
+
+const onRendered = (msg: FromWorker): void => {
+  const entry = chunks.get(msg.chunk);
+  if (!entry) return;
+  if (msg.type === "done") {
+    if (msg.error) console.error(`Render worker failed in frames ${chunkRange(msg.chunk).start}+:`, msg.error);
+    entry.done = true;
+  } else {
+    const { pixels, index, renderStartedUs, renderMs } = msg;
+    if (msg.chunk === resumeChunk && index < resumeIndex) return;
+    entry.frames.push({
+      pixels: Buffer.from(pixels.buffer, pixels.byteOffset, pixels.byteLength),
+      index,
+      renderStartedUs,
+      renderMs,
+    });
+  }
+  wake?.();
+  wake = null;
+};
+
+/** Frames rendered and not yet taken. */
+const renderedAhead = (): number => {
+  let n = 0;
+  chunks.forEach((entry) => (n += entry.frames.length));
+  return n;
+};
+
+/** Start RENDER_WORKERS render threads on the loaded movie. */
+const startRenderAhead = (): void => {
+  if (RENDER_WORKERS <= 0) return;
+  const cpus = allowedCpus();
+  if (cpus.includes(SENDER_CPU)) {
+    throw new Error(`Pinned to CPUs ${cpus.join(",")}: CPU ${SENDER_CPU} belongs to the Sender`);
+  }
+  if (cpus.length < 2) {
+    console.warn(`Render-ahead: ${RENDER_WORKERS} workers share CPU ${cpus.join(",")} with the main thread`);
+  }
+
+  const setup: RenderSetup = { movie, brightness: player.brightness };
+  for (let i = 0; i < RENDER_WORKERS; i++) {
+    const worker = new Worker(new URL("./render.js", import.meta.url), { workerData: setup });
+    worker.on("message", onRendered);
+    worker.on("error", (err: Error) => {
+      console.error("Render worker died:", err);
+      process.exit(1);
+    });
+    workers.push(worker);
+  }
+  console.log(`Render-ahead: ${RENDER_WORKERS} workers on CPUs ${cpus.join(",")}`);
+  dispatch();
+};
+
+/** The next frame in order: from the render-ahead ranges, or rendered here without workers. */
+const renderFrame = async (): Promise<Rendered> => {
+  if (!workers.length) {
+    const renderStartedUs = nowUs();
+    const started = performance.now();
+    player.play();
+    const index = (player.frame || player.frames) - 1;
+    const pixels = player.movie!.sign.wire ? player.getWireRows() : player.getImageData();
+    return { pixels, index, renderStartedUs, renderMs: performance.now() - started };
+  }
+  for (;;) {
+    const entry = chunks.get(chunkRead)!;
+    const frame = entry.frames.shift();
+    if (frame) return frame;
+    if (entry.done) {
+      chunks.delete(chunkRead++);
+      dispatch();
+      continue;
+    }
+    await new Promise<void>((resolve) => (wake = resolve));
+  }
+};
+
+/**
+ * Drop whatever was rendered ahead (the workers go idle once their queued
+ * ranges are done; late results are ignored).
+ */
+const pauseRendering = (): void => {
+  chunks.clear();
+  wake = null;
+};
+
+/** Carry on rendering live from frame `index` of the cycle. */
+const resumeRendering = (index: number): void => {
+  if (!workers.length) {
+    player.frame = index;
+    return;
+  }
+  /* The next range number (all earlier ones may still answer) that covers `index`. */
+  const perCycle = Math.ceil(player.frames / RENDER_CHUNK_FRAMES) || 1;
+  const target = Math.floor(index / RENDER_CHUNK_FRAMES);
+  chunks.clear();
+  chunkNext += (target - (chunkNext % perCycle) + perCycle) % perCycle;
+  chunkRead = resumeChunk = chunkNext;
+  resumeIndex = index;
+  dispatch();
+};
+
+// ── Movie cache ─────────────────────────────────────────────────────
+// Movies loop for hours, and every cycle renders the same frames. With
+// MOVIE_CACHE_MB > 0 the first full cycle rendered for a key (movie hash,
+// theme, theme cycle, brightness bucket) is recorded as it goes out:
+// each frame deflated (level 1; a mostly flat LED canvas shrinks 20-100x)
+// and a frame identical to the one before stored once. From the next
+// cycle on, frames are inflated from the cache and the Player (or its
+// workers) sits idle. A brightness change outside the bucket switches to
+// that bucket's cycle if it is cached, and otherwise renders live again
+// from the next frame of the cycle, recording from the next cycle start.
+// Least recently used cycles are evicted past MOVIE_CACHE_MB.
+
+interface CacheEntry {
+  frames: Buffer[];                      /* Deflated pixels; a repeat is the same Buffer again */
+  indices: number[];                     /* Frame of the cycle each one is */
+  bytes: number;
+  rawBytes: number;
+}
+
+const cache = new Map<string, CacheEntry>(); /* Least recently used first */
+let cacheBytes = 0;
+let movieHash = "";
+let themeCycle = 0;                      /* player.cycles when the movie was built */
+let recording: { key: string; entry: CacheEntry } | null = null;
+let recordedPixels = Buffer.alloc(0);    /* Last distinct frame recorded, to spot repeats */
+const tooBig = new Set<string>();        /* Keys whose cycle outgrew MOVIE_CACHE_MB */
+let replay: { key: string; entry: CacheEntry; pos: number; pixels: Buffer | null } | null = null;
+let lastIndex = Number.MAX_SAFE_INTEGER; /* Frame of the cycle handed out last (start: a new cycle) */
+
+/** Remember what the Player was loaded with, for the cache key. */
+const cacheMovie = (loaded: Movie): void => {
+  movieHash = createHash("sha1").update(JSON.stringify(loaded)).digest("hex").slice(0, 12);
+  themeCycle = player.cycles;
+};
+
+const cacheKey = (): string =>
+  `${movieHash}/${player.movie!.sign.theme}/${themeCycle}/${player.brightness}`;
+
+const cacheState = (): string =>
+  `${replay ? "replay" : recording ? "record" : "live"} (${cache.size} cycles, ${(cacheBytes / 1048576).toFixed(1)} MB)`;
+
+/** Store a finished cycle, evicting the least recently used past MOVIE_CACHE_MB. */
+const cacheCommit = (key: string, entry: CacheEntry): void => {
+  cacheBytes -= cache.get(key)?.bytes ?? 0;
+  cache.delete(key);
+  cache.set(key, entry);
+  cacheBytes += entry.bytes;
+  for (const [oldKey, old] of cache) {
+    if (cacheBytes <= MOVIE_CACHE_MB * 1048576 || old === entry) break;
+    cache.delete(oldKey);
+    cacheBytes -= old.bytes;
+  }
+  const distinct = new Set(entry.frames).size;
+  console.log(
+    `Cache: ${key} — ${entry.frames.length} frames (${distinct} distinct),` +
+      ` ${(entry.bytes / 1048576).toFixed(2)} MB of ${(entry.rawBytes / 1048576).toFixed(1)} MB;` +
+      ` ${cache.size} cycles, ${(cacheBytes / 1048576).toFixed(1)} MB in all`,
+  );
+};
+
+/** Mark a cycle most recently used. */
+const cacheTouch = (key: string, entry: CacheEntry): void => {
+  cache.delete(key);
+  cache.set(key, entry);
+};
+
+/** Add a frame rendered live to the cycle being recorded. */
+const cacheRecord = (frame: Rendered): void => {
+  const entry = recording!.entry;
+  const last = entry.frames.length - 1;
+  const same = last >= 0 && recordedPixels.equals(frame.pixels);
+  const packed = same ? entry.frames[last] : deflateRawSync(frame.pixels, { level: 1 });
+  if (!same) {
+    entry.bytes += packed.length;
+    if (recordedPixels.length !== frame.pixels.length) recordedPixels = Buffer.allocUnsafe(frame.pixels.length);
+    frame.pixels.copy(recordedPixels);
+  }
+  entry.frames.push(packed);
+  entry.indices.push(frame.index);
+  entry.rawBytes += frame.pixels.length;
+  if (entry.bytes > MOVIE_CACHE_MB * 1048576) {
+    console.warn(`Cache: ${recording!.key} won't fit in ${MOVIE_CACHE_MB} MB, rendering it live`);
+    tooBig.add(recording!.key);
+    recording = null;
+  }
+};
+
+/** The next frame from the cycle being replayed. */
+const replayFrame = (): Rendered => {
+  const r = replay!;
+  const renderStartedUs = nowUs();
+  const started = performance.now();
+  const packed = r.entry.frames[r.pos];
+  if (!r.pixels || packed !== r.entry.frames[(r.pos || r.entry.frames.length) - 1]) r.pixels = inflateRawSync(packed);
+  lastIndex = r.entry.indices[r.pos];
+  r.pos = (r.pos + 1) % r.entry.frames.length;
+  return { pixels: r.pixels, index: lastIndex, renderStartedUs, renderMs: performance.now() - started };
+};
+
+/** The next frame in order: from the cache when the cycle is in it, rendered otherwise. */
+const nextFrame = async (): Promise<Rendered> => {
+  if (MOVIE_CACHE_MB <= 0) return renderFrame();
+
+  if (replay && replay.key !== cacheKey()) {
+    /* Brightness moved to another bucket: same cycle, other pixels. */
+    const key = cacheKey();
+    const entry = cache.get(key);
+    if (entry && entry.frames.length === replay.entry.frames.length) {
+      cacheTouch(key, entry);
+      replay = { key, entry, pos: replay.pos, pixels: null };
+    } else {
+      replay = null;
+      resumeRendering((lastIndex + 1) % player.frames);
+    }
+  }
+  if (replay) return replayFrame();
+
+  const frame = await renderFrame();
+  /* Ranges handed out before a brightness change were (partly) drawn at the old level. */
+  const current = !workers.length || chunkRead >= brightChunk;
+  const key = cacheKey();
+  const cycleStart = frame.index <= lastIndex;
+  lastIndex = frame.index;
+  if (cycleStart) {
+    if (recording) cacheCommit(recording.key, recording.entry);
+    recording = null;
+    const entry = current ? cache.get(key) : undefined;
+    if (entry && entry.indices[0] === frame.index) {
+      /* This frame was rendered anyway; the cache takes over from the next one. */
+      pauseRendering();
+      cacheTouch(key, entry);
+      replay = { key, entry, pos: 1 % entry.frames.length, pixels: null };
+      return frame;
+    }
+    if (current && !tooBig.has(key)) recording = { key, entry: { frames: [], indices: [], bytes: 0, rawBytes: 0 } };
+  }
+  if (recording && (recording.key !== key || !current)) recording = null;   /* Brightness changed mid-cycle */
+  if (recording) cacheRecord(frame);
+  return frame;
+};
+
+// ── GC pressure ─────────────────────────────────────────────────────
+// A frame has ~4 ms at 240 FPS, so a collection landing in the wrong one
+// is a slip. V8's GC profiler hands back every collection of the stats
+// interval with its pause and the heap before and after it: the pauses
+// go into a histogram, and the bytes freed plus the heap's growth are
+// what the loop allocated. Buffer contents live outside the V8 heap and
+// are freed lazily, so they are shown as a gauge instead of a rate.
+
+let gcProfiler = new GCProfiler();
+let gcHeapUsed = 0;                      /* V8 heap in use when the interval started */
+const gcPauses = createHistogram();      /* us */
+
+/** Start collecting the next interval's GC figures. */
+const gcRestart = (): void => {
+  gcProfiler = new GCProfiler();
+  gcProfiler.start();
+  gcHeapUsed = getHeapStatistics().used_heap_size;
+  gcPauses.reset();
+};
+
+/** The interval's collections and allocation per frame, for the flow line. */
+const gcReport = (frames: number): string => {
+  const { statistics } = gcProfiler.stop();
+  let freed = 0;
+  statistics.forEach(({ cost, beforeGC, afterGC }) => {
+    gcPauses.record(Math.max(1, Math.round(cost)));
+    freed += beforeGC.heapStatistics.usedHeapSize - afterGC.heapStatistics.usedHeapSize;
+  });
+  const allocated = getHeapStatistics().used_heap_size - gcHeapUsed + freed;
+  const ms = (us: number): string => (us / 1000).toFixed(2);
+  const line =
+    `GC: ${statistics.length}` +
+    (statistics.length ? ` (${ms(gcPauses.percentile(50))}/${ms(gcPauses.percentile(99))}/${ms(gcPauses.max)} ms p50/p99/max)` : "") +
+    `, ${frames ? (allocated / frames / 1024).toFixed(1) : "-"} KB/frame heap` +
+    `, ${(process.memoryUsage().arrayBuffers / 1048576).toFixed(1)} MB buffers`;
+  gcRestart();
+  return line;
+};
+
 // ── Graceful shutdown ───────────────────────────────────────────────
 
 const shutdown = async (): Promise<void> => {
@@ -154,35 +814,41 @@ process.on("SIGTERM", shutdown);
   await subscriber.subscribe(BRIGHTNESS_CHANNEL);
 
   const storedBrightness = await redis.get(BRIGHTNESS_KEY);
-  if (storedBrightness) player.brightness = Number(storedBrightness);
+  if (storedBrightness) setBrightness(Number(storedBrightness));
   player.load(movie);
+  cacheMovie(movie);
+  setHeaderMovie();
+  startRenderAhead();
+
+  /* Start with nothing in flight: frames and acks from a previous run don't pair with ours. */
+  await redis.del(PLAYER_FRAMES_KEY, PLAYER_STREAM_KEY, SENDER_CREDITS_KEY);
+  const target = Number(await redis.get(SENDER_QUEUE_TARGET_KEY));
+  if (target > 0) queueTarget = target;
+  transport = (await redis.get(SENDER_TRANSPORT_KEY)) ?? "list";
+  let statsStarted = performance.now();
+  gcRestart();
 
   while (true) {
     try {
-      player.play();
-      const frame = player.getImageData();
+      await waitForCredit();
 
-      let pushed = await redis.rpush(PLAYER_FRAMES_KEY, frame);
+      const { pixels, renderStartedUs, renderMs } = await nextFrame();
+      flow.renderSumMs += renderMs;
+      flow.renderMaxMs = Math.max(flow.renderMaxMs, renderMs);
+      const { width, height } = player.movie!.sign;
+      const frame = buildFrame(stampHeader(width, height), pixels);
 
-      /*
-       * Back-pressure: if the Redis list has accumulated one full second
-       * of frames (FPS), the sender may be stalled. Wait briefly, then
-       * double-check — if the list is still full, flush it and pause to
-       * avoid unbounded memory growth.
-       */
-      const fps = player.movie!.sign.fps ?? FPS;
-      if (pushed === fps) {
-        await sleep(SENDER_WAIT_MS);
-        pushed = await redis.llen(PLAYER_FRAMES_KEY);
-        if (pushed === fps) {
-          await Promise.all([
-            redis.del(PLAYER_FRAMES_KEY),
-            sleep(PLAYER_BACKOFF_MS),
-          ]);
-        }
+      flow.depthSum += await pushFrame(frame, renderStartedUs);
+      flow.frames++;
+
+      const elapsed = performance.now() - statsStarted;
+      if (elapsed >= STATS_INTERVAL_MS) {
+        await reportFlow(elapsed);
+        statsStarted = performance.now();
       }
     } catch (err) {
       console.error("Error in playback loop:", err);
+      haveLastPixels = false;
       await sleep(ERROR_BACKOFF_MS);
     }
   }
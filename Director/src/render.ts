@@ -0,0 +1,94 @@
+/*
+ * render.ts — Render-ahead worker for the Director
+ *
+ * Runs on a worker_threads thread with its own skia-canvas Canvas and its
+ * own Player, loaded with the same movie as the main thread. The Director
+ * hands it frame ranges ([start, end) of one movie cycle); it renders each
+ * range front to back and posts every frame's pixels back, transferred
+ * rather than copied, followed by a "done" for the range. The Director
+ * reassembles the ranges of all workers in order (see direct.ts).
+ *
+ * Player.play() is a seek plus a draw, so a frame depends only on its
+ * index: a worker can start anywhere in the cycle and produce exactly the
+ * frames the main thread would have. play() skips frames where nothing is
+ * animating; one that skips past the end of the range belongs to the next
+ * range and is left to its worker.
+ *
+ * Data flow:
+ *   Director → {render, chunk, start, end} → play() ×n → {frame, pixels} … {done}
+ *   Director → {brightness, value}         → player.brightness
+ */
+
+import path from "path";
+import { fileURLToPath } from "url";
+import { parentPort, workerData } from "worker_threads";
+import { Canvas, FontLibrary } from "skia-canvas";
+import Player from "@myled/player";
+import type { Movie } from "@myled/player";
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+// ── Messages ────────────────────────────────────────────────────────
+
+export interface RenderSetup {
+  movie: Movie;
+  brightness: number;
+}
+
+export type ToWorker =
+  | { type: "render"; chunk: number; start: number; end: number }
+  | { type: "brightness"; value: number };
+
+export type FromWorker =
+  | { type: "frame"; chunk: number; index: number; pixels: Uint8Array; renderStartedUs: number; renderMs: number }
+  | { type: "done"; chunk: number; error?: string };
+
+// ── Worker ──────────────────────────────────────────────────────────
+
+if (parentPort) {
+  const port = parentPort;
+  const { movie, brightness } = workerData as RenderSetup;
+
+  FontLibrary.use("Inter", [path.join(__dirname, "..", "fonts", "Inter.ttf")]);
+
+  const canvas = new Canvas(movie.sign.width, movie.sign.height);
+  const player = new Player(canvas);
+  player.brightness = brightness;
+  player.load(movie);
+
+  const post = (msg: FromWorker, transfer: ArrayBuffer[] = []): void => port.postMessage(msg, transfer);
+  const nowUs = (): number => (performance.timeOrigin + performance.now()) * 1000;
+
+  /** Render frames start..end-1 (those with something animating) and post them in order. */
+  const renderRange = (chunk: number, start: number, end: number): void => {
+    player.frame = start;
+    for (;;) {
+      const renderStartedUs = nowUs();
+      const started = performance.now();
+      player.play();
+      const index = (player.frame || player.frames) - 1;
+      if (index < start || index >= end) break;
+
+      /* getWireRows() reuses its buffer and getImageData() may share skia's: post a copy of our own. */
+      const rendered = player.movie!.sign.wire ? player.getWireRows() : player.getImageData();
+      const pixels = new Uint8Array(rendered.length);
+      pixels.set(rendered);
+      const renderMs = performance.now() - started;
+      post({ type: "frame", chunk, index, pixels, renderStartedUs, renderMs }, [pixels.buffer]);
+      if (index === end - 1) break;
+    }
+  };
+
+  port.on("message", (msg: ToWorker) => {
+    if (msg.type === "brightness") {
+      player.brightness = msg.value;
+      return;
+    }
+    try {
+      renderRange(msg.chunk, msg.start, msg.end);
+      post({ type: "done", chunk: msg.chunk });
+    } catch (err) {
+      post({ type: "done", chunk: msg.chunk, error: String(err) });
+    }
+  });
+}
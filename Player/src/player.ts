@@ -24,6 +24,7 @@
  * Data flow:
  *   Movie JSON → Player.load() → GSAP timeline
  *   Player.play() → seek + draw → getImageData() → RGBA Buffer → Redis
+ *                                 (or getWireRows() → packet-ready RGB rows)
  */
 
 import { gsap } from "gsap";
@@ -33,6 +34,7 @@ import { gsap } from "gsap";
 const FPS = 240;
 const BRIGHTNESS_SCALING_FACTOR = 0.7;
 const DARK_BOOST = 0.1;
+const WIRE_ROW_HEADROOM = 21;            /* Ethernet + FPGA row header, filled in by the Sender */
 
 // ── Interfaces ──────────────────────────────────────────────────────
 
@@ -66,10 +68,12 @@ interface PlayerImageData {
 }
 
 export interface Sign {
-  width: number;
+  width: number;                /* Render size; below the panel's (e.g. 160x32) the Sender upscales */
   height: number;
   theme: string;
-  fps?: number;
+  fps?: number;                 /* Render rate, default 240 */
+  interpolate?: boolean;        /* Sender blends up to 240 Hz between frames (fps 60 or 120) */
+  wire?: boolean;               /* Ship packet-ready RGB rows (getWireRows()); render size = panel's */
 }
 
 export interface Fills {
@@ -363,6 +367,7 @@ class Player {
   cycles: number;
   brightness: number;
   private _movie!: Movie;
+  private wireRows: Buffer;
 
   constructor(canvas: PlayerCanvas) {
     this.canvas = canvas;
@@ -375,6 +380,7 @@ class Player {
     this.duration = 0;
     this.cycles = 0;
     this.brightness = 100;
+    this.wireRows = Buffer.alloc(0);
   }
 
   /** Compile the raw Movie into a BuiltMovie with resolved timeline functions. */
@@ -405,6 +411,31 @@ class Player {
     );
   }
 
+  /**
+   * Extract the current canvas as packet-ready rows (the wire format in
+   * Sender/src/frame.h): per row, WIRE_ROW_HEADROOM bytes for the Sender
+   * to fill, then RGB triplets in the channel order the Sender's own
+   * conversion uses. The buffer is reused from frame to frame.
+   */
+  getWireRows(): Buffer {
+    const { width, height } = this.movie!.sign;
+    const stride = WIRE_ROW_HEADROOM + width * 3;
+    if (this.wireRows.length !== stride * height) this.wireRows = Buffer.alloc(stride * height);
+
+    const src = this.getImageData();
+    const dst = this.wireRows;
+    let s = 0;
+    for (let y = 0; y < height; y++) {
+      let d = y * stride + WIRE_ROW_HEADROOM;
+      for (let x = 0; x < width; x++, s += 4, d += 3) {
+        dst[d] = src[s + 2];
+        dst[d + 1] = src[s + 1];
+        dst[d + 2] = src[s];
+      }
+    }
+    return dst;
+  }
+
   /**
    * Load a movie definition and build the GSAP timeline.
    *
@@ -448,7 +479,7 @@ class Player {
        higher layers paint on top. */
     this.animations.sort((a, b) => a.layer - b.layer);
     this.duration = this.timeline!.duration();
-    this.frames = Math.ceil(this.duration * FPS);
+    this.frames = Math.ceil(this.duration * (this.movie!.sign.fps ?? FPS));
     this.frame = 0;
   }
 
@@ -0,0 +1,123 @@
+/*
+ * arena.c — memfd arena on hugepages when available
+ *
+ * A hugetlb memfd only maps if enough hugepages are reserved; without
+ * them mmap() fails up front (the reservation is checked at map time),
+ * so the fallback is clean. A plain memfd is asked for transparent
+ * hugepages with MADV_HUGEPAGE before it is touched — the first write to
+ * each 2 MB extent is what allocates a huge page — and /proc/self/smaps
+ * tells afterwards whether it got them.
+ *
+ * Pre-faulting is a write to every page: MAP_POPULATE alone would map
+ * the pages before the madvise() could take effect.
+ */
+
+#define _GNU_SOURCE
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ── Internal constants ──────────────────────────────────────────────
+
+#define DEFAULT_HUGEPAGE_SIZE (2u << 20)
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+static size_t round_up(size_t n, size_t to) {
+  return (n + to - 1) / to * to;
+}
+
+/** Default hugepage size from /proc/meminfo ("Hugepagesize: 2048 kB"). */
+static size_t hugepage_size(void) {
+  FILE *f = fopen("/proc/meminfo", "r");
+  char line[128];
+  size_t kb = 0;
+  while (f && fgets(line, sizeof(line), f))
+    if (sscanf(line, "Hugepagesize: %zu kB", &kb) == 1) break;
+  if (f) fclose(f);
+  return kb ? kb << 10 : DEFAULT_HUGEPAGE_SIZE;
+}
+
+/** kB of the mapping at `base` that sit on huge pages, per /proc/self/smaps. */
+static size_t huge_kb(const void *base) {
+  FILE *f = fopen("/proc/self/smaps", "r");
+  char line[256];
+  char start[32];
+  size_t kb = 0;
+  int in_mapping = 0;
+  snprintf(start, sizeof(start), "%lx-", (unsigned long)(uintptr_t)base);
+  while (f && fgets(line, sizeof(line), f)) {
+    if (strchr(line, '-') && strchr(line, ' ') > strchr(line, '-')) {
+      if (in_mapping) break;
+      in_mapping = strncmp(line, start, strlen(start)) == 0;
+    } else if (in_mapping && sscanf(line, "ShmemPmdMapped: %zu kB", &kb) == 1) {
+      break;
+    }
+  }
+  if (f) fclose(f);
+  return kb;
+}
+
+/** memfd of `size` bytes mapped shared, or NULL. */
+static uint8_t *map_memfd(unsigned int flags, size_t size, int *fd_out) {
+  int fd = memfd_create("sender-arena", MFD_CLOEXEC | flags);
+  if (fd < 0) return NULL;
+  if (ftruncate(fd, (off_t)size) < 0) {
+    close(fd);
+    return NULL;
+  }
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+  *fd_out = fd;
+  return base;
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+int arena_create(arena_t *arena, size_t size) {
+  const size_t huge = hugepage_size();
+  memset(arena, 0, sizeof(*arena));
+  arena->fd = -1;
+
+  arena->size = round_up(size, huge);
+  arena->base = map_memfd(MFD_HUGETLB, arena->size, &arena->fd);
+  if (arena->base) {
+    arena->backing = "hugetlb";
+  } else {
+    arena->base = map_memfd(0, arena->size, &arena->fd);
+    if (arena->base == NULL) {
+      perror("arena");
+      return -1;
+    }
+    madvise(arena->base, arena->size, MADV_HUGEPAGE);
+  }
+
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  for (size_t off = 0; off < arena->size; off += page)
+    arena->base[off] = 0;
+
+  if (arena->backing == NULL)
+    arena->backing = huge_kb(arena->base) ? "transparent hugepages" : "small pages";
+  printf("Arena: %zu KB on %s\n", arena->size >> 10, arena->backing);
+  return 0;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  size_t at = round_up(arena->used, ARENA_ALIGN);
+  if (at + size > arena->size) return NULL;
+  arena->used = at + size;
+  return arena->base + at;
+}
+
+void arena_destroy(arena_t *arena) {
+  if (arena->base) munmap(arena->base, arena->size);
+  if (arena->fd >= 0) close(arena->fd);
+  arena->base = NULL;
+  arena->fd = -1;
+}
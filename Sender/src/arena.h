@@ -0,0 +1,50 @@
+/*
+ * arena.h — One pre-faulted mapping for the frame loop's buffers
+ *
+ * The row packets, the retained keyframe, the blend output and the test
+ * pattern canvas are carved from a single arena instead of scattered
+ * statics: every block starts on a cache line, the whole arena is touched
+ * once at startup so the frame loop never takes a page fault in it, and
+ * it is backed by hugepages where the system has them, so the buffers a
+ * frame walks through (~2 MB at the largest geometry) need one TLB entry
+ * instead of hundreds.
+ *
+ * Backing, in order of preference:
+ *
+ *   hugetlb                 MFD_HUGETLB, needs vm.nr_hugepages reserved
+ *   transparent hugepages   shmem THP (shmem_enabled = advise or always)
+ *   small pages             plain memfd
+ *
+ * It is a memfd either way, so the fd can be handed to a successor (see
+ * handover.h), which copies the row packets from its head.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGN 64                  /* Cache line */
+
+// ── Arena ───────────────────────────────────────────────────────────
+
+typedef struct {
+  uint8_t    *base;
+  size_t      size;            /* Mapped bytes, rounded up to the backing's page size */
+  size_t      used;
+  int         fd;              /* memfd behind the mapping */
+  const char *backing;         /* For the log: "hugetlb", "transparent hugepages", ... */
+} arena_t;
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Map and pre-fault an arena of at least `size` bytes. Returns 0 on success. */
+extern int   arena_create(arena_t *arena, size_t size);
+
+/* Next ARENA_ALIGN-aligned, zeroed block of `size` bytes, NULL if full. */
+extern void *arena_alloc(arena_t *arena, size_t size);
+
+extern void  arena_destroy(arena_t *arena);
+
+#endif /* ARENA_H */
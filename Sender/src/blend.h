@@ -0,0 +1,26 @@
+/*
+ * blend.h — Temporal interpolation between two keyframes
+ *
+ * A movie can be rendered below the panel rate (60 or 120 FPS) and
+ * flagged FRAME_FLAG_INTERPOLATE (see frame.h). The Sender then fills
+ * the slots between two keyframes with a linear blend of the pair,
+ * weighted by where each slot falls between their presentation times.
+ *
+ * The blend runs on the BGRA canvas before conversion, so colour
+ * correction, panel remap and idle detection see an ordinary frame.
+ */
+
+#ifndef BLEND_H
+#define BLEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLEND_ONE 256                   /* Weight of the later keyframe, Q8 */
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* out = a * (BLEND_ONE - weight) + b * weight, rounded, per byte. */
+extern void blend_frames(const uint8_t *a, const uint8_t *b, uint8_t *out, size_t len, int weight);
+
+#endif /* BLEND_H */
@@ -0,0 +1,401 @@
+/*
+ * config.c — Sender configuration file parser
+ *
+ * The file format is deliberately trivial so it can be edited over SSH
+ * without tooling:
+ *
+ *   # comment
+ *   key = value
+ *
+ * Unknown keys and malformed values reject the whole file — a reload
+ * either applies completely or not at all, so a typo can never leave the
+ * sign half-configured. Parsing happens into a scratch copy that is only
+ * written back to the caller on success.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LEN 256
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+/** Trim leading and trailing whitespace in place. */
+static char *trim(char *s) {
+  while (isspace((unsigned char)*s)) s++;
+  char *end = s + strlen(s);
+  while (end > s && isspace((unsigned char)end[-1])) end--;
+  *end = '\0';
+  return s;
+}
+
+static int parse_int(const char *value, int min, int max, int *out) {
+  char *end;
+  errno = 0;
+  long v = strtol(value, &end, 0);
+  if (errno || *end != '\0' || v < min || v > max) return -1;
+  *out = (int)v;
+  return 0;
+}
+
+static int parse_double(const char *value, double min, double max, double *out) {
+  char *end;
+  errno = 0;
+  double v = strtod(value, &end);
+  if (errno || *end != '\0' || v < min || v > max) return -1;
+  *out = v;
+  return 0;
+}
+
+/** Parse "aa:bb:cc:dd:ee:ff" into the lower 48 bits of a uint64_t. */
+static int parse_mac(const char *value, uint64_t *out) {
+  unsigned int b[6];
+  char tail;
+  if (sscanf(value, "%x:%x:%x:%x:%x:%x%c",
+             &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &tail) != 6)
+    return -1;
+  uint64_t mac = 0;
+  for (int i = 0; i < 6; i++) {
+    if (b[i] > 0xFF) return -1;
+    mac = (mac << 8) | b[i];
+  }
+  *out = mac;
+  return 0;
+}
+
+static int parse_idle_mode(const char *value, idle_mode_t *out) {
+  if (strcmp(value, "off") == 0)           *out = IDLE_OFF;
+  else if (strcmp(value, "commit") == 0)   *out = IDLE_COMMIT;
+  else if (strcmp(value, "throttle") == 0) *out = IDLE_THROTTLE;
+  else return -1;
+  return 0;
+}
+
+static int parse_queue_policy(const char *value, queue_policy_t *out) {
+  if (strcmp(value, "smooth") == 0)    *out = QUEUE_SMOOTH;
+  else if (strcmp(value, "live") == 0) *out = QUEUE_LIVE;
+  else return -1;
+  return 0;
+}
+
+static int parse_transport(const char *value, transport_t *out) {
+  if (strcmp(value, "list") == 0)        *out = TRANSPORT_LIST;
+  else if (strcmp(value, "stream") == 0) *out = TRANSPORT_STREAM;
+  else return -1;
+  return 0;
+}
+
+static const char *pattern_names[] = {
+  "off", "solid", "gradient", "bars", "checker", "rows", "counter",
+};
+
+static int parse_pattern(const char *value, pattern_t *out) {
+  for (int i = 0; i < (int)(sizeof(pattern_names) / sizeof(pattern_names[0])); i++) {
+    if (strcmp(value, pattern_names[i]) == 0) {
+      *out = (pattern_t)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/** Parse "RRGGBB" (optionally "#RRGGBB") into 0xRRGGBB. */
+static int parse_color(const char *value, uint32_t *out) {
+  unsigned int rgb;
+  char tail;
+  if (*value == '#') value++;
+  if (strlen(value) != 6 || sscanf(value, "%x%c", &rgb, &tail) != 1) return -1;
+  *out = rgb;
+  return 0;
+}
+
+static int parse_pattern_rate(const char *value, int *unpaced) {
+  if (strcmp(value, "paced") == 0)    *unpaced = 0;
+  else if (strcmp(value, "max") == 0) *unpaced = 1;
+  else return -1;
+  return 0;
+}
+
+/** "off", "unix:/path" or "host:port" (host may be empty for all addresses). */
+static int parse_listen(const char *value, char *out, size_t size) {
+  if (*value == '\0' || strlen(value) >= size) return -1;
+  if (strcmp(value, "off") != 0 && strncmp(value, "unix:/", 6) != 0) {
+    const char *colon = strrchr(value, ':');
+    if (colon == NULL || atoi(colon + 1) <= 0 || atoi(colon + 1) > 65535) return -1;
+  }
+  strncpy(out, value, size - 1);
+  out[size - 1] = '\0';
+  return 0;
+}
+
+/*
+ * Parse "x y w h m00 m01 m02 m10 m11 m12 m20 m21 m22": a canvas rectangle
+ * followed by a row-major 3x3 matrix in plain decimals (1.0 = identity
+ * gain), converted to Q8 fixed point for the conversion kernel.
+ */
+static int parse_ccm(const char *value, ccm_region_t *out) {
+  double m[9];
+  char tail;
+  if (sscanf(value, "%d %d %d %d %lf %lf %lf %lf %lf %lf %lf %lf %lf %c",
+             &out->x, &out->y, &out->w, &out->h,
+             &m[0], &m[1], &m[2], &m[3], &m[4], &m[5], &m[6], &m[7], &m[8], &tail) != 13)
+    return -1;
+  if (out->x < 0 || out->y < 0 || out->w < 1 || out->h < 1 ||
+      out->x + out->w > CONFIG_MAX_WIDTH || out->y + out->h > CONFIG_MAX_HEIGHT)
+    return -1;
+  for (int i = 0; i < 9; i++) {
+    if (m[i] < -4.0 || m[i] > 4.0) return -1;
+    out->m[i] = (int32_t)lround(m[i] * CCM_ONE);
+  }
+  return 0;
+}
+
+/** Parse "W H" for the layout slot size. */
+static int parse_panel_size(const char *value, sender_config_t *cfg) {
+  char tail;
+  if (sscanf(value, "%d %d %c", &cfg->panel_width, &cfg->panel_height, &tail) != 2)
+    return -1;
+  return (cfg->panel_width >= 1 && cfg->panel_height >= 1) ? 0 : -1;
+}
+
+/** Parse "x y rotation flip" for one panel in chain order. */
+static int parse_panel(const char *value, panel_layout_t *out) {
+  char flip[8];
+  char tail;
+  if (sscanf(value, "%d %d %d %7s %c", &out->x, &out->y, &out->rotation, flip, &tail) != 4)
+    return -1;
+  if (out->x < 0 || out->y < 0) return -1;
+  if (out->rotation != 0 && out->rotation != 90 && out->rotation != 180 && out->rotation != 270)
+    return -1;
+  if (strcmp(flip, "none") == 0)   out->flip = FLIP_NONE;
+  else if (strcmp(flip, "h") == 0) out->flip = FLIP_H;
+  else if (strcmp(flip, "v") == 0) out->flip = FLIP_V;
+  else return -1;
+  return 0;
+}
+
+/*
+ * Build the brightness LUT. Requested brightness (0-255, from Redis) is
+ * normalised, shaped by the gamma curve, then squeezed into
+ * [brightness_min, brightness_max]. Zero always maps to zero so "off"
+ * stays off regardless of the floor.
+ */
+static void build_brightness_lut(sender_config_t *cfg) {
+  cfg->brightness_lut[0] = 0;
+  for (int i = 1; i < 256; i++) {
+    double shaped = pow(i / 255.0, cfg->brightness_gamma);
+    double out = cfg->brightness_min + shaped * (cfg->brightness_max - cfg->brightness_min);
+    cfg->brightness_lut[i] = (uint8_t)lround(out);
+  }
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+void config_defaults(sender_config_t *cfg) {
+  memset(cfg, 0, sizeof(*cfg));
+  strncpy(cfg->nic_name, CONFIG_DEFAULT_NIC, IFNAMSIZ - 1);
+  cfg->dest_mac          = CONFIG_DEFAULT_DEST_MAC;
+  cfg->sign_width        = CONFIG_DEFAULT_WIDTH;
+  cfg->sign_height       = CONFIG_DEFAULT_HEIGHT;
+  cfg->fps               = CONFIG_DEFAULT_FPS;
+  cfg->sleep_threshold_s = 0.000200;
+  cfg->sleep_margin_s    = 0.000100;
+  cfg->stats_interval    = CONFIG_DEFAULT_FPS;
+  cfg->brightness_min    = 0;
+  cfg->brightness_max    = 255;
+  cfg->brightness_gamma  = 1.0;
+  cfg->idle_mode         = IDLE_OFF;
+  cfg->idle_after        = CONFIG_DEFAULT_FPS;
+  cfg->idle_fps          = 30;
+  strncpy(cfg->handover_name, CONFIG_DEFAULT_HANDOVER, sizeof(cfg->handover_name) - 1);
+  cfg->redis_batch_max   = CONFIG_DEFAULT_BATCH;
+  cfg->queue_target      = CONFIG_DEFAULT_QUEUE_TARGET;
+  cfg->queue_policy      = QUEUE_SMOOTH;
+  cfg->transport         = TRANSPORT_LIST;
+  cfg->max_latency_ms    = 50;
+  cfg->pts_late_ms       = 8;
+  cfg->pattern           = PATTERN_OFF;
+  cfg->pattern_color     = 0xFFFFFF;
+  cfg->pattern_unpaced   = 0;
+  strncpy(cfg->recorder_dir, CONFIG_DEFAULT_RECORDER_DIR, sizeof(cfg->recorder_dir) - 1);
+  cfg->recorder_miss_ms  = 2;
+  strncpy(cfg->metrics_listen, CONFIG_DEFAULT_METRICS, sizeof(cfg->metrics_listen) - 1);
+  build_brightness_lut(cfg);
+}
+
+/*
+ * Load `path` on top of the built-in defaults. Returns 0 and overwrites
+ * `cfg` on success; returns -1 and leaves `cfg` untouched if the file is
+ * missing or any line fails to parse.
+ */
+int config_load(const char *path, sender_config_t *cfg) {
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Config: cannot open %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  sender_config_t next;
+  config_defaults(&next);
+
+  char line[LINE_MAX_LEN];
+  int lineno = 0;
+  int errors = 0;
+
+  while (fgets(line, sizeof(line), fp)) {
+    lineno++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    char *s = trim(line);
+    if (*s == '\0') continue;
+
+    char *eq = strchr(s, '=');
+    if (eq == NULL) {
+      fprintf(stderr, "Config: %s:%d: expected key = value\n", path, lineno);
+      errors++;
+      continue;
+    }
+    *eq = '\0';
+    char *key = trim(s);
+    char *value = trim(eq + 1);
+    int rc;
+
+    if (strcmp(key, "interface") == 0) {
+      rc = (*value && strlen(value) < IFNAMSIZ) ? 0 : -1;
+      if (rc == 0) strncpy(next.nic_name, value, IFNAMSIZ - 1);
+    } else if (strcmp(key, "dest_mac") == 0) {
+      rc = parse_mac(value, &next.dest_mac);
+    } else if (strcmp(key, "width") == 0) {
+      rc = parse_int(value, 1, CONFIG_MAX_WIDTH, &next.sign_width);
+    } else if (strcmp(key, "height") == 0) {
+      rc = parse_int(value, 1, CONFIG_MAX_HEIGHT, &next.sign_height);
+    } else if (strcmp(key, "fps") == 0) {
+      rc = parse_int(value, 1, 1000, &next.fps);
+    } else if (strcmp(key, "sleep_threshold_us") == 0) {
+      rc = parse_double(value, 0, 100000, &next.sleep_threshold_s);
+      next.sleep_threshold_s /= 1e6;
+    } else if (strcmp(key, "sleep_margin_us") == 0) {
+      rc = parse_double(value, 0, 100000, &next.sleep_margin_s);
+      next.sleep_margin_s /= 1e6;
+    } else if (strcmp(key, "stats_interval") == 0) {
+      rc = parse_int(value, 1, 1000000, &next.stats_interval);
+    } else if (strcmp(key, "brightness_min") == 0) {
+      rc = parse_int(value, 0, 255, &next.brightness_min);
+    } else if (strcmp(key, "brightness_max") == 0) {
+      rc = parse_int(value, 0, 255, &next.brightness_max);
+    } else if (strcmp(key, "brightness_gamma") == 0) {
+      rc = parse_double(value, 0.1, 10.0, &next.brightness_gamma);
+    } else if (strcmp(key, "idle_mode") == 0) {
+      rc = parse_idle_mode(value, &next.idle_mode);
+    } else if (strcmp(key, "idle_after") == 0) {
+      rc = parse_int(value, 1, 1000000, &next.idle_after);
+    } else if (strcmp(key, "idle_fps") == 0) {
+      rc = parse_int(value, 1, 1000, &next.idle_fps);
+    } else if (strcmp(key, "handover_socket") == 0) {
+      rc = (*value && strlen(value) < sizeof(next.handover_name)) ? 0 : -1;
+      if (rc == 0) strncpy(next.handover_name, value, sizeof(next.handover_name) - 1);
+    } else if (strcmp(key, "recorder_dir") == 0) {
+      rc = (*value && strlen(value) < sizeof(next.recorder_dir)) ? 0 : -1;
+      if (rc == 0) strncpy(next.recorder_dir, value, sizeof(next.recorder_dir) - 1);
+    } else if (strcmp(key, "recorder_miss_ms") == 0) {
+      rc = parse_int(value, 0, 1000, &next.recorder_miss_ms);
+    } else if (strcmp(key, "metrics_listen") == 0) {
+      rc = parse_listen(value, next.metrics_listen, sizeof(next.metrics_listen));
+    } else if (strcmp(key, "redis_batch_max") == 0) {
+      rc = parse_int(value, 1, CONFIG_MAX_BATCH, &next.redis_batch_max);
+    } else if (strcmp(key, "queue_target") == 0) {
+      rc = parse_int(value, 1, 1000, &next.queue_target);
+    } else if (strcmp(key, "queue_policy") == 0) {
+      rc = parse_queue_policy(value, &next.queue_policy);
+    } else if (strcmp(key, "transport") == 0) {
+      rc = parse_transport(value, &next.transport);
+    } else if (strcmp(key, "max_latency_ms") == 0) {
+      rc = parse_int(value, 1, 10000, &next.max_latency_ms);
+    } else if (strcmp(key, "pts_late_ms") == 0) {
+      rc = parse_int(value, 1, 10000, &next.pts_late_ms);
+    } else if (strcmp(key, "ccm") == 0) {
+      rc = next.ccm_count < CONFIG_MAX_CCM ? parse_ccm(value, &next.ccm[next.ccm_count]) : -1;
+      if (rc == 0) next.ccm_count++;
+    } else if (strcmp(key, "panel_size") == 0) {
+      rc = parse_panel_size(value, &next);
+    } else if (strcmp(key, "serpentine") == 0) {
+      rc = parse_int(value, 0, 1, &next.serpentine);
+    } else if (strcmp(key, "panel") == 0) {
+      rc = next.panel_count < CONFIG_MAX_PANELS ? parse_panel(value, &next.panels[next.panel_count]) : -1;
+      if (rc == 0) next.panel_count++;
+    } else if (strcmp(key, "pattern") == 0) {
+      rc = parse_pattern(value, &next.pattern);
+    } else if (strcmp(key, "pattern_color") == 0) {
+      rc = parse_color(value, &next.pattern_color);
+    } else if (strcmp(key, "pattern_rate") == 0) {
+      rc = parse_pattern_rate(value, &next.pattern_unpaced);
+    } else {
+      fprintf(stderr, "Config: %s:%d: unknown key '%s'\n", path, lineno, key);
+      errors++;
+      continue;
+    }
+
+    if (rc != 0) {
+      fprintf(stderr, "Config: %s:%d: invalid value for %s: '%s'\n", path, lineno, key, value);
+      errors++;
+    }
+  }
+  fclose(fp);
+
+  if (next.brightness_min > next.brightness_max) {
+    fprintf(stderr, "Config: %s: brightness_min > brightness_max\n", path);
+    errors++;
+  }
+  if (next.idle_fps > next.fps) {
+    fprintf(stderr, "Config: %s: idle_fps > fps\n", path);
+    errors++;
+  }
+  if (next.sleep_margin_s > next.sleep_threshold_s) {
+    fprintf(stderr, "Config: %s: sleep_margin_us > sleep_threshold_us\n", path);
+    errors++;
+  }
+  if (next.panel_count) {
+    int slots = 0;
+    if (next.panel_width && next.sign_width % next.panel_width == 0 &&
+        next.sign_height % next.panel_height == 0)
+      slots = (next.sign_width / next.panel_width) * (next.sign_height / next.panel_height);
+    if (slots != next.panel_count) {
+      fprintf(stderr, "Config: %s: %d panel lines for %d panel_size slots\n",
+              path, next.panel_count, slots);
+      errors++;
+    }
+    for (int i = 0; i < next.panel_count; i++) {
+      const panel_layout_t *p = &next.panels[i];
+      int turned = p->rotation == 90 || p->rotation == 270;
+      int w = turned ? next.panel_height : next.panel_width;
+      int h = turned ? next.panel_width : next.panel_height;
+      if (p->x + w > next.sign_width || p->y + h > next.sign_height) {
+        fprintf(stderr, "Config: %s: panel %d falls outside the canvas\n", path, i);
+        errors++;
+      }
+    }
+  }
+  if (errors) {
+    fprintf(stderr, "Config: %s rejected (%d error%s), keeping current settings\n",
+            path, errors, errors == 1 ? "" : "s");
+    return -1;
+  }
+
+  build_brightness_lut(&next);
+  *cfg = next;
+  return 0;
+}
+
+/** True if moving from `from` to `to` requires reopening the socket or resizing buffers. */
+int config_is_disruptive(const sender_config_t *from, const sender_config_t *to) {
+  return strcmp(from->nic_name, to->nic_name) != 0 ||
+         from->dest_mac != to->dest_mac ||
+         from->sign_width != to->sign_width ||
+         from->sign_height != to->sign_height;
+}
@@ -0,0 +1,168 @@
+/*
+ * config.h — Runtime configuration for the Sender
+ *
+ * Settings that used to be compile-time constants (interface, MAC,
+ * geometry, timing margins, brightness policy) are read from a plain
+ * "key = value" file at startup and again on SIGHUP. See sender.conf
+ * for the full list of keys and their defaults.
+ *
+ * Settings fall into two groups:
+ *
+ *   Non-disruptive — timing, stats, brightness LUT, idle policy. Applied
+ *                    in place at the next frame boundary.
+ *   Disruptive     — interface, MAC, geometry. Require reopening the raw
+ *                    socket and resizing buffers, so they are staged and
+ *                    switched in the slack right after a frame commit.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <net/if.h>
+#include <stdint.h>
+
+// ── Defaults ────────────────────────────────────────────────────────
+
+#define CONFIG_DEFAULT_PATH         "sender.conf"
+#define CONFIG_DEFAULT_NIC          "eth0"
+#define CONFIG_DEFAULT_DEST_MAC     0x112233445566ULL  /* FPGA receiver default MAC */
+#define CONFIG_DEFAULT_WIDTH        320                /* Pixels per row */
+#define CONFIG_DEFAULT_HEIGHT       64                 /* Rows (scanlines) */
+#define CONFIG_DEFAULT_FPS          240                /* Target refresh rate */
+#define CONFIG_DEFAULT_HANDOVER     "partstopixels-sender" /* Abstract socket name */
+#define CONFIG_MAX_WIDTH            480                /* Row packet must fit one Ethernet frame */
+#define CONFIG_MAX_HEIGHT           256                /* Row index is a single byte */
+#define CONFIG_MAX_CCM              16                 /* Colour-corrected panel regions */
+#define CCM_ONE                     256                /* 1.0 in the Q8 matrix coefficients */
+#define CONFIG_MAX_PANELS           64                 /* Panels in a remapped layout */
+#define CONFIG_DEFAULT_BATCH        8                  /* Frames per Redis round trip, at most */
+#define CONFIG_MAX_BATCH            64
+#define CONFIG_DEFAULT_QUEUE_TARGET 4                  /* Frames the Director keeps in flight */
+#define CONFIG_DEFAULT_RECORDER_DIR "/tmp"             /* Flight-recorder dumps */
+#define CONFIG_DEFAULT_METRICS      "127.0.0.1:9464"   /* Prometheus endpoint */
+
+// ── Configuration ───────────────────────────────────────────────────
+
+/*
+ * What the Sender does once the same frame has been popped `idle_after`
+ * times in a row. Rows are never re-sent while idle; the FPGA keeps the
+ * last rows it latched.
+ */
+typedef enum {
+  IDLE_OFF,        /* Always send rows + commit (original behaviour) */
+  IDLE_COMMIT,     /* Commit packet only, every slot */
+  IDLE_THROTTLE,   /* Commit packet only, at idle_fps */
+} idle_mode_t;
+
+/*
+ * What to do when the Redis queue backs up. Smooth shows every frame, however
+ * late; live keeps the panel within max_latency_ms of the newest frame by
+ * dropping the backlog (countdowns, scores, anything on a clock).
+ */
+typedef enum {
+  QUEUE_SMOOTH,    /* Never drop (original behaviour) */
+  QUEUE_LIVE,      /* Skip to the newest frame past max_latency_ms */
+} queue_policy_t;
+
+/*
+ * How frames travel from the Director. The list is popped (BLMPOP) and
+ * frames have no identity on the way. The stream (XADD MAXLEN ~ / XREAD
+ * BLOCK) gives every frame an ID carrying its render time, so the Sender
+ * knows where it is in the queue and how old each frame is at commit.
+ */
+typedef enum {
+  TRANSPORT_LIST,  /* player:frames list (original behaviour) */
+  TRANSPORT_STREAM,/* player:stream, IDs = render time */
+} transport_t;
+
+/*
+ * Built-in frame source. Anything but PATTERN_OFF replaces the Redis
+ * queue with frames generated in place (see pattern.h), for burn-in,
+ * wiring checks and transport benchmarks without Director/Player.
+ */
+typedef enum {
+  PATTERN_OFF,     /* Frames come from Redis (normal operation) */
+  PATTERN_SOLID,   /* Every pixel pattern_color */
+  PATTERN_GRADIENT,/* Red across, green down, blue cycling per frame */
+  PATTERN_BARS,    /* Eight colour bars scrolling one pixel per frame */
+  PATTERN_CHECKER, /* 8x8 checkerboard, inverted once per second */
+  PATTERN_ROWS,    /* Each row a colour encoding its row index */
+  PATTERN_COUNTER, /* Frame counter in every pixel, for the emulator */
+} pattern_t;
+
+/*
+ * Per-panel colour correction: a 3x3 matrix applied to every pixel inside
+ * a canvas rectangle, out = M x (R, G, B). Later regions win where they
+ * overlap; pixels outside every region pass through unchanged.
+ */
+typedef struct {
+  int       x, y, w, h;           /* Canvas rectangle the matrix applies to */
+  int32_t   m[9];                 /* Row-major matrix, Q8 fixed point (CCM_ONE = 1.0) */
+} ccm_region_t;
+
+/*
+ * Physical panel layout. The FPGA's wire frame is cut into panel-sized
+ * slots numbered in chain order: left to right, top to bottom, or
+ * right to left on every other slot row when serpentine. Each "panel"
+ * line (in chain order) says which canvas area its slot shows and how the
+ * panel is mounted. Rotation is clockwise; 90/270 panels cover a
+ * panel_h x panel_w canvas area. Flip is applied in panel space first.
+ */
+typedef enum { FLIP_NONE, FLIP_H, FLIP_V } panel_flip_t;
+
+typedef struct {
+  int       x, y;                 /* Canvas top-left of the area this slot shows */
+  int       rotation;             /* 0, 90, 180 or 270 */
+  panel_flip_t flip;
+} panel_layout_t;
+
+typedef struct {
+  /* Disruptive: switched between commits */
+  char      nic_name[IFNAMSIZ];   /* Interface carrying the raw L2 traffic */
+  uint64_t  dest_mac;             /* FPGA receiver MAC */
+  int       sign_width;           /* Pixels per row */
+  int       sign_height;          /* Rows (scanlines) */
+
+  /* Non-disruptive: applied at the next frame boundary */
+  int       fps;                  /* Target refresh rate */
+  double    sleep_threshold_s;    /* Below this, spin-wait only */
+  double    sleep_margin_s;       /* Wake early by this amount */
+  int       stats_interval;       /* Frames between FPS reports */
+  int       brightness_min;       /* Brightness LUT output floor */
+  int       brightness_max;       /* Brightness LUT output ceiling */
+  double    brightness_gamma;     /* Brightness LUT curve (1.0 = linear) */
+  idle_mode_t idle_mode;          /* Static-content refresh policy */
+  int       idle_after;           /* Identical frames before going idle */
+  int       idle_fps;             /* Commit rate while idle (throttle only) */
+  char      handover_name[64];    /* Abstract Unix socket for binary handover */
+  int       redis_batch_max;      /* Frames popped per round trip, at most (1 = BLPOP) */
+  int       queue_target;         /* Director credit: frames in flight, published to Redis */
+  queue_policy_t queue_policy;    /* Backlog handling */
+  transport_t transport;          /* Frame queue, published to Redis for the Director */
+  int       max_latency_ms;       /* Live policy: deepest backlog tolerated */
+  int       pts_late_ms;          /* Drop a timestamped frame this far past its PTS */
+  ccm_region_t ccm[CONFIG_MAX_CCM]; /* Colour-correction table (one "ccm" line each) */
+  int       ccm_count;
+  int       panel_width;          /* Layout slot size (0 = no remap) */
+  int       panel_height;
+  int       serpentine;           /* Reverse chain order on odd slot rows */
+  panel_layout_t panels[CONFIG_MAX_PANELS]; /* One "panel" line each, chain order */
+  int       panel_count;
+  pattern_t pattern;              /* Frame source (PATTERN_OFF = Redis) */
+  uint32_t  pattern_color;        /* 0xRRGGBB for PATTERN_SOLID */
+  int       pattern_unpaced;      /* 1 = no deadline wait: throughput benchmark */
+  char      recorder_dir[200];    /* Where flight-recorder dumps are written */
+  int       recorder_miss_ms;     /* Auto-dump when a commit is this late (0 = off) */
+  char      metrics_listen[108];  /* "host:port", "unix:/path" or "off" (read at startup only) */
+
+  /* Derived by config_load(), not read from the file */
+  uint8_t   brightness_lut[256];  /* Requested brightness → wire brightness */
+} sender_config_t;
+
+// ── Public API ──────────────────────────────────────────────────────
+
+extern void config_defaults(sender_config_t *cfg);
+extern int  config_load(const char *path, sender_config_t *cfg);
+extern int  config_is_disruptive(const sender_config_t *from, const sender_config_t *to);
+
+#endif /* CONFIG_H */
@@ -0,0 +1,221 @@
+/*
+ * control.c — Control-plane thread and seqlock
+ *
+ * The thread keeps two Redis connections: one subscribed to the keyspace
+ * channels of sender:brightness and sender:overlay, one for the GET that
+ * follows each notification (a subscribed connection can't issue
+ * commands). Whoever sets a key needs nothing new — a plain
+ * `SET sender:brightness 128` still works — as long as Redis emits
+ * keyspace events for string, generic (DEL) and expiry events, so the
+ * thread adds "K$gx" to notify-keyspace-events if missing.
+ *
+ * A dropped connection is re-established after a second and the key is
+ * re-read, so nothing set in between is lost. None of this runs on the
+ * frame loop's core (see thread.h).
+ *
+ * Seqlock: the single writer bumps `seq` to odd, stores the values, and
+ * bumps it back to even. Readers retry while it is odd or changed under
+ * them. The fields are word-sized atomics, so a torn read is impossible
+ * even while retrying.
+ *
+ * Overlay triple buffer: `overlay_back` belongs to the thread and
+ * `overlay_front` to the frame loop; `overlay_middle` is exchanged by
+ * both, with OVERLAY_FRESH set by the thread's exchange and cleared by
+ * the loop's. Neither side ever touches a buffer the other one holds.
+ */
+
+#include "control.h"
+#include "config.h"
+#include "metrics.h"
+#include "thread.h"
+#include <hiredis/hiredis.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ── Internal constants ──────────────────────────────────────────────
+
+#define KEYSPACE_PREFIX      "__keyspace@0__:"
+#define BRIGHTNESS_CHANNEL   KEYSPACE_PREFIX CONTROL_BRIGHTNESS_KEY
+#define OVERLAY_CHANNEL      KEYSPACE_PREFIX CONTROL_OVERLAY_KEY
+#define KEYSPACE_CLASSES     "$gx"    /* Strings, generic (DEL), expiry; "A" covers all */
+#define RECONNECT_DELAY_S    1
+#define OVERLAY_MAX_BYTES    (CONFIG_MAX_WIDTH * CONFIG_MAX_HEIGHT * 4)
+#define OVERLAY_FRESH        4        /* Flag on overlay_middle: not taken yet */
+
+// ── Module state ────────────────────────────────────────────────────
+
+static uint32_t seq = 0;               /* Even = stable, odd = write in progress */
+static control_values_t shared = { .brightness = -1 };
+static const char *socket_path = NULL;
+
+static uint8_t overlay_buf[3][OVERLAY_MAX_BYTES];
+static size_t overlay_len[3];
+static int overlay_back = 0;           /* Thread's */
+static int overlay_middle = 1;         /* Shared: index | OVERLAY_FRESH */
+static int overlay_front = 2;          /* Frame loop's */
+static size_t overlay_set_len = 0;     /* Thread's view of the key */
+
+// ── Seqlock ─────────────────────────────────────────────────────────
+
+static void publish(const control_values_t *values) {
+  __atomic_store_n(&seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&shared.brightness, values->brightness, __ATOMIC_RELAXED);
+  __atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+int control_read(control_values_t *out, uint32_t *seen) {
+  uint32_t before, after;
+  do {
+    before = __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+    out->brightness = __atomic_load_n(&shared.brightness, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    after = __atomic_load_n(&seq, __ATOMIC_RELAXED);
+  } while ((before & 1) || before != after);
+
+  if (after == *seen) return 0;
+  *seen = after;
+  return 1;
+}
+
+// ── Overlay hand-off ────────────────────────────────────────────────
+
+static void publish_overlay(const char *bgra, size_t len) {
+  if (len) memcpy(overlay_buf[overlay_back], bgra, len);
+  overlay_len[overlay_back] = len;
+  overlay_back = __atomic_exchange_n(&overlay_middle, overlay_back | OVERLAY_FRESH,
+                                     __ATOMIC_ACQ_REL) & ~OVERLAY_FRESH;
+  overlay_set_len = len;
+}
+
+int control_take_overlay(const uint8_t **bgra, size_t *len) {
+  if (!(__atomic_load_n(&overlay_middle, __ATOMIC_RELAXED) & OVERLAY_FRESH)) return 0;
+  overlay_front = __atomic_exchange_n(&overlay_middle, overlay_front,
+                                      __ATOMIC_ACQ_REL) & ~OVERLAY_FRESH;
+  *bgra = overlay_buf[overlay_front];
+  *len = overlay_len[overlay_front];
+  return 1;
+}
+
+// ── Redis side ──────────────────────────────────────────────────────
+
+/** Connect once; NULL (after logging) if Redis isn't there. */
+static redisContext *connect_once(void) {
+  redisContext *c = redisConnectUnix(socket_path);
+  if (c == NULL || c->err) {
+    fprintf(stderr, "ERROR: Control Redis connection: %s\n", c ? c->errstr : "allocation");
+    if (c) redisFree(c);
+    return NULL;
+  }
+  return c;
+}
+
+/** Make sure SET, DEL and expiry of the keys are announced on their keyspace channels. */
+static void enable_notifications(redisContext *c) {
+  redisReply *r = redisCommand(c, "CONFIG GET notify-keyspace-events");
+  if (r && r->type == REDIS_REPLY_ARRAY && r->elements == 2 &&
+      r->element[1]->type == REDIS_REPLY_STRING) {
+    const char *flags = r->element[1]->str;
+    const int all_classes = strchr(flags, 'A') != NULL;
+    char wanted[64];
+    snprintf(wanted, sizeof(wanted), "%.40s", flags);
+    size_t n = strlen(wanted);
+    if (strchr(flags, 'K') == NULL) wanted[n++] = 'K';
+    for (const char *k = KEYSPACE_CLASSES; *k; k++)
+      if (!all_classes && strchr(flags, *k) == NULL) wanted[n++] = *k;
+    wanted[n] = '\0';
+    if (strcmp(wanted, flags) != 0) {
+      redisReply *s = redisCommand(c, "CONFIG SET notify-keyspace-events %s", wanted);
+      if (s && s->type == REDIS_REPLY_ERROR)
+        fprintf(stderr, "ERROR: Control: cannot enable keyspace events: %s\n", s->str);
+      if (s) freeReplyObject(s);
+    }
+  }
+  if (r) freeReplyObject(r);
+}
+
+/** GET the key and publish it if it holds a valid level. Returns -1 on a broken connection. */
+static int refresh_brightness(redisContext *c) {
+  redisReply *r = redisCommand(c, "GET %s", CONTROL_BRIGHTNESS_KEY);
+  if (r == NULL) return -1;
+  if (r->type == REDIS_REPLY_STRING) {
+    int level = atoi(r->str);
+    if (level >= 0 && level <= 255 && level != shared.brightness) {
+      control_values_t values = { .brightness = level };
+      publish(&values);
+    }
+  }
+  freeReplyObject(r);
+  return 0;
+}
+
+/*
+ * GET the overlay and hand it over; a missing or empty key clears it. The
+ * size is checked by the frame loop, which knows the geometry. Returns -1
+ * on a broken connection.
+ */
+static int refresh_overlay(redisContext *c) {
+  redisReply *r = redisCommand(c, "GET %s", CONTROL_OVERLAY_KEY);
+  if (r == NULL) return -1;
+  if (r->type == REDIS_REPLY_STRING && r->len > OVERLAY_MAX_BYTES) {
+    fprintf(stderr, "ERROR: Control: %s is %zu bytes, over %d\n",
+            CONTROL_OVERLAY_KEY, r->len, OVERLAY_MAX_BYTES);
+  } else if (r->type == REDIS_REPLY_STRING) {
+    publish_overlay(r->str, r->len);
+  } else if (r->type == REDIS_REPLY_NIL && overlay_set_len != 0) {
+    publish_overlay(NULL, 0);
+  }
+  freeReplyObject(r);
+  return 0;
+}
+
+/*
+ * One connected session: subscribe first, then read the key, so a SET
+ * landing in between is still seen (at worst twice). Returns when either
+ * connection breaks.
+ */
+static void run_session(redisContext *cmd, redisContext *sub) {
+  enable_notifications(cmd);
+
+  redisReply *r = redisCommand(sub, "SUBSCRIBE %s %s", BRIGHTNESS_CHANNEL, OVERLAY_CHANNEL);
+  if (r == NULL) return;
+  freeReplyObject(r);
+
+  if (refresh_brightness(cmd) < 0 || refresh_overlay(cmd) < 0) return;
+
+  for (;;) {
+    if (redisGetReply(sub, (void **)&r) != REDIS_OK) return;
+    int status = 0;
+    if (r->type == REDIS_REPLY_ARRAY && r->elements == 3 &&
+        r->element[0]->type == REDIS_REPLY_STRING &&
+        r->element[1]->type == REDIS_REPLY_STRING &&
+        strcmp(r->element[0]->str, "message") == 0) {
+      if (strcmp(r->element[1]->str, OVERLAY_CHANNEL) == 0) status = refresh_overlay(cmd);
+      else status = refresh_brightness(cmd);
+    }
+    freeReplyObject(r);
+    if (status < 0) return;
+  }
+}
+
+static void *control_main(void *arg) {
+  for (int session = 0;; session++) {
+    if (session > 0) metric_add(&metrics.control_reconnects, 1);
+    redisContext *cmd = connect_once();
+    redisContext *sub = cmd ? connect_once() : NULL;
+    if (cmd && sub) run_session(cmd, sub);
+    if (sub) redisFree(sub);
+    if (cmd) redisFree(cmd);
+    sleep(RECONNECT_DELAY_S);
+  }
+  return NULL;
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+int control_start(const char *path) {
+  socket_path = path;
+  return thread_start_background("sender-control", control_main, NULL);
+}
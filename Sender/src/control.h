@@ -0,0 +1,53 @@
+/*
+ * control.h — Control plane: brightness without a per-frame round trip
+ *
+ * Control values used to ride along with every frame pop (GET
+ * sender:brightness pipelined after BLPOP), i.e. 240 extra commands a
+ * second for a value that changes a few times an hour. A background
+ * thread now owns them instead: it reads sender:brightness once on
+ * connect, then waits for keyspace notifications on that key (see
+ * control.c) and publishes each new value through a seqlock.
+ *
+ * The frame loop only ever reads the seqlock — a couple of loads, no
+ * syscall, no lock — right before a commit, so a change lands in exactly
+ * the next commit packet.
+ *
+ * sender:overlay carries the overlay plane the same way: a BGRA canvas of
+ * the sign's size with straight alpha, composited over every frame (see
+ * convert.c). SET it to show an alert or banner, DEL it (or let an EX
+ * expire) to clear it — the Director's timeline is never involved. The
+ * buffer is too big for a seqlock, so it is handed over by triple
+ * buffering: the thread fills a spare buffer and swaps it in, and the
+ * frame loop swaps it out, each with one atomic exchange.
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CONTROL_BRIGHTNESS_KEY "sender:brightness"
+#define CONTROL_OVERLAY_KEY    "sender:overlay"
+
+// ── Control values ──────────────────────────────────────────────────
+
+typedef struct {
+  int brightness;              /* Requested brightness 0-255 (before the LUT), -1 = not known yet */
+} control_values_t;
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Start the control thread against the Redis Unix socket at `path`. */
+extern int control_start(const char *path);
+
+/* Copy the current values into `out`. Returns 1 if they changed since the
+   generation stored in `*seen` (which is then updated), 0 otherwise. */
+extern int control_read(control_values_t *out, uint32_t *seen);
+
+/* Take the overlay if it changed since the last call: returns 1 and
+   points `*bgra` at it (`*len` bytes, 0 = cleared) until the next call
+   that returns 1; returns 0, touching nothing, if it didn't change. */
+extern int control_take_overlay(const uint8_t **bgra, size_t *len);
+
+#endif /* CONTROL_H */
@@ -0,0 +1,489 @@
+/*
+ * convert.c — BGRA → RGB row packets with per-panel colour correction
+ *
+ * Signs mix LED panel batches with visibly different white points. Each
+ * "ccm" line in sender.conf names a canvas rectangle and a 3x3 matrix;
+ * convert_prepare() flattens those rectangles into per-row spans so the
+ * hot path never tests rectangles per pixel:
+ *
+ *   row 12:  [0,64) plain   [64,128) ccm 0   [128,320) plain
+ *
+ * Plain spans are a straight channel swizzle. Corrected spans run the
+ * matrix in Q8 fixed point, four pixels per 128-bit vector using GCC
+ * vector extensions — under -march=native these lower to NEON on the
+ * Pi 5 (and SSE elsewhere), with no intrinsics to keep in sync per ISA.
+ *
+ * Rotated, mirrored and serpentine-chained panel layouts (see
+ * panel_layout_t) are compiled into a flat gather table: wire pixel →
+ * canvas pixel. Each wire row is gathered into an L1-resident scratch row
+ * and then converted by the same span kernels, so remapping costs one
+ * indexed load per pixel and the identity layout skips it entirely.
+ *
+ * A frame rendered below the sign's resolution (see frame.h) is upscaled
+ * by nearest neighbour through the same gather: the layout table is
+ * composed with the source → wire scaling once per source size, and a
+ * wire row that gathers exactly the pixels of the row above (every other
+ * row at 2x) is a copy of that row's converted bytes instead of a second
+ * conversion.
+ *
+ * An overlay plane (alerts, a clock, a "closed" banner — see control.h)
+ * is composited over every frame in the same pass. convert_set_overlay()
+ * reorders it into wire order and records, per wire row, the runs of
+ * pixels that aren't fully transparent; a row without runs costs one
+ * test, and only the covered pixels are blended (or copied, for a fully
+ * opaque run) into the scratch row ahead of the span kernels.
+ *
+ * Wire-format frames (see frame.h) arrive already converted. When the
+ * config leaves nothing to do to them — identity layout, no colour
+ * correction, no overlay — the Sender only has convert_write_headers()
+ * fill in the FPGA headers; otherwise convert_unpack_wire() turns them
+ * back into a canvas for convert_frame().
+ */
+
+#include "convert.h"
+#include "socket.h"
+#include <string.h>
+
+// ── Span table ──────────────────────────────────────────────────────
+
+#define MAX_SPANS CONFIG_MAX_WIDTH           /* Remapped rows can alternate regions every pixel */
+#define SPAN_PLAIN (-1)
+
+typedef struct {
+  uint16_t x0, x1;                           /* [x0, x1) in wire pixels */
+  int16_t  ccm;                              /* Index into matrices, or SPAN_PLAIN */
+} span_t;
+
+/* sign_width is capped at CONFIG_MAX_WIDTH by config_load(), so a row never outgrows its table. */
+_Static_assert(MAX_SPANS >= CONFIG_MAX_WIDTH, "a row may need one span per pixel");
+
+static span_t   spans[CONFIG_MAX_HEIGHT][MAX_SPANS];
+static uint16_t span_count[CONFIG_MAX_HEIGHT];
+static int32_t  matrices[CONFIG_MAX_CCM][9];
+
+// ── Gather table ────────────────────────────────────────────────────
+
+static uint32_t gather[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH]; /* Wire pixel → canvas pixel */
+static int      remap_active = 0;                             /* 0 = identity, skip gather */
+
+// ── Upscale table ───────────────────────────────────────────────────
+
+static uint32_t scaled[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH]; /* Wire pixel → source pixel */
+static uint8_t  row_repeats[CONFIG_MAX_HEIGHT];               /* Wire row converts like the one above */
+static int      scaled_width = 0;                             /* Source size of `scaled`, 0 = none */
+static int      scaled_height = 0;
+
+// ── Overlay plane ───────────────────────────────────────────────────
+
+#define MAX_RUNS (CONFIG_MAX_WIDTH / 2 + 1)   /* Runs are at least one gap apart */
+
+typedef struct {
+  uint16_t x0, x1;                           /* [x0, x1) in wire pixels */
+  uint8_t  opaque;                           /* All alpha 255: copy instead of blending */
+} run_t;
+
+static uint32_t overlay_canvas[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH]; /* As set, canvas order */
+static uint32_t overlay_wire[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH];   /* Wire pixel → overlay BGRA */
+static run_t    overlay_runs[CONFIG_MAX_HEIGHT][MAX_RUNS];
+static uint16_t overlay_run_count[CONFIG_MAX_HEIGHT];                 /* 0 = row untouched */
+static int      overlay_width = 0;                                    /* Size as set, 0 = none */
+static int      overlay_height = 0;
+static int      prepared_width = 0;                                   /* Geometry of the tables */
+static int      prepared_height = 0;
+static int      spans_plain = 1;                                      /* No ccm span on any row */
+static int      overlay_total = 0;                                    /* Runs in overlay_runs */
+
+// ── Vector types ────────────────────────────────────────────────────
+
+#define LANES 4                              /* Pixels per 128-bit vector */
+
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint16_t v16u16 __attribute__((vector_size(32)));
+typedef int32_t  v4i32 __attribute__((vector_size(16)));
+typedef uint8_t  v16u8 __attribute__((vector_size(16)));
+
+/* Each pixel's alpha word (high byte) copied to both of its words. */
+static const v16u16 ALPHA_WORDS = { 1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15 };
+
+/* Byte shuffle packing four 0x00BBGGRR words into 12 bytes of RGB. */
+static const v16u8 PACK_RGB = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15 };
+
+/** Clamp each lane to 0-255 using compare masks (C has no vector ?:). */
+static inline v4i32 clamp_u8(v4i32 v) {
+  v &= ~(v < 0);
+  v4i32 over = v > 255;
+  return (v & ~over) | (over & 255);
+}
+
+// ── Kernels ─────────────────────────────────────────────────────────
+
+/** Straight BGRA → RGB swizzle. */
+static void convert_plain(const uint8_t *src, uint8_t *dst, int n) {
+  for (int i = 0; i < n; i++) {
+    dst[0] = src[2]; /* R */
+    dst[1] = src[1]; /* G */
+    dst[2] = src[0]; /* B */
+    src += BYTES_PER_PIXEL;
+    dst += 3;
+  }
+}
+
+/** Scalar matrix for the tail of a span (fewer than LANES pixels). */
+static void convert_ccm_scalar(const uint8_t *src, uint8_t *dst, int n, const int32_t m[9]) {
+  for (int i = 0; i < n; i++) {
+    int32_t r = src[2], g = src[1], b = src[0];
+    for (int c = 0; c < 3; c++) {
+      int32_t v = (m[c * 3] * r + m[c * 3 + 1] * g + m[c * 3 + 2] * b + CCM_ONE / 2) >> 8;
+      dst[c] = v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+    }
+    src += BYTES_PER_PIXEL;
+    dst += 3;
+  }
+}
+
+/*
+ * LANES pixels per step: split the BGRA words into channel lanes, three
+ * multiply-accumulates per output channel in Q8, round, clamp, and
+ * re-interleave as RGB.
+ */
+static void convert_ccm(const uint8_t *src, uint8_t *dst, int n, const int32_t m[9]) {
+  int i = 0;
+  for (; i + LANES <= n; i += LANES) {
+    v4u32 px;
+    memcpy(&px, src, sizeof(px));
+    v4i32 b = (v4i32)(px & 0xFF);
+    v4i32 g = (v4i32)((px >> 8) & 0xFF);
+    v4i32 r = (v4i32)((px >> 16) & 0xFF);
+
+    v4i32 ro = clamp_u8((r * m[0] + g * m[1] + b * m[2] + CCM_ONE / 2) >> 8);
+    v4i32 go = clamp_u8((r * m[3] + g * m[4] + b * m[5] + CCM_ONE / 2) >> 8);
+    v4i32 bo = clamp_u8((r * m[6] + g * m[7] + b * m[8] + CCM_ONE / 2) >> 8);
+
+    v4u32 rgb0 = (v4u32)(ro | (go << 8) | (bo << 16));
+    v16u8 packed = __builtin_shuffle((v16u8)rgb0, PACK_RGB);
+    memcpy(dst, &packed, LANES * 3);
+    src += LANES * BYTES_PER_PIXEL;
+    dst += LANES * 3;
+  }
+  convert_ccm_scalar(src, dst, n - i, m);
+}
+
+/** Overlay alpha as a Q8 weight: 0-255 → 0-256, so 255 yields the overlay exactly. */
+static inline uint32_t overlay_weight(uint32_t px) {
+  return (px >> 24) + (px >> 31);
+}
+
+/*
+ * Composite `n` overlay pixels (straight alpha) over a BGRA row in place,
+ * eight per step viewed as sixteen 16-bit words, like blend.c: even and
+ * odd bytes are blended in place in the low and high half of each word
+ * (255 * 256 + 128 still fits), with each pixel's alpha shuffled into
+ * both of its words. The tail does the same on the two halves of a
+ * 32-bit word.
+ */
+static void overlay_blend(uint8_t *row, const uint32_t *ov, int n) {
+  int i = 0;
+  for (; i + 2 * LANES <= n; i += 2 * LANES) {
+    v16u16 px, o;
+    memcpy(&px, row + i * BYTES_PER_PIXEL, sizeof(px));
+    memcpy(&o, ov + i, sizeof(o));
+    v16u16 alpha = __builtin_shuffle(o, ALPHA_WORDS) >> 8;
+    v16u16 wo = alpha + (alpha >> 7);            /* overlay_weight(), per word */
+    v16u16 wp = 256 - wo;
+    v16u16 even = ((px & 0xFF) * wp + (o & 0xFF) * wo + 128) >> 8;
+    v16u16 odd  = ((px >> 8) * wp + (o >> 8) * wo + 128) & 0xFF00;
+    v16u16 res = even | odd;
+    memcpy(row + i * BYTES_PER_PIXEL, &res, sizeof(res));
+  }
+  for (; i < n; i++) {
+    uint32_t px, o = ov[i];
+    memcpy(&px, row + i * BYTES_PER_PIXEL, sizeof(px));
+    uint32_t wo = overlay_weight(o), wp = 256 - wo;
+    uint32_t rb = (((px & 0x00FF00FF) * wp + (o & 0x00FF00FF) * wo + 0x00800080) >> 8) & 0x00FF00FF;
+    uint32_t ga = (((px >> 8) & 0x00FF00FF) * wp + ((o >> 8) & 0x00FF00FF) * wo + 0x00800080) & 0xFF00FF00;
+    px = rb | ga;
+    memcpy(row + i * BYTES_PER_PIXEL, &px, sizeof(px));
+  }
+}
+
+/** Apply the overlay runs of wire row `y` to its BGRA scratch row. */
+static void overlay_row(uint8_t *row, int y, int width) {
+  const uint32_t *ov = overlay_wire + y * width;
+  for (int r = 0; r < overlay_run_count[y]; r++) {
+    const run_t *run = &overlay_runs[y][r];
+    uint8_t *px = row + run->x0 * BYTES_PER_PIXEL;
+    if (run->opaque)
+      memcpy(px, ov + run->x0, (size_t)(run->x1 - run->x0) * BYTES_PER_PIXEL);
+    else
+      overlay_blend(px, ov + run->x0, run->x1 - run->x0);
+  }
+}
+
+// ── Layout compiler ─────────────────────────────────────────────────
+
+/*
+ * Fill the gather table from the panel layout. Returns 1 if the result is
+ * anything other than the identity mapping.
+ */
+static int build_gather(const sender_config_t *cfg) {
+  const int width = cfg->sign_width;
+  const int height = cfg->sign_height;
+
+  for (int i = 0; i < width * height; i++) gather[i] = (uint32_t)i;
+  if (cfg->panel_count == 0) return 0;
+
+  const int pw = cfg->panel_width;
+  const int ph = cfg->panel_height;
+  const int slots_per_row = width / pw;
+
+  for (int slot = 0; slot < cfg->panel_count; slot++) {
+    const panel_layout_t *p = &cfg->panels[slot];
+    int slot_row = slot / slots_per_row;
+    int slot_col = slot % slots_per_row;
+    if (cfg->serpentine && (slot_row & 1)) slot_col = slots_per_row - 1 - slot_col;
+
+    for (int v = 0; v < ph; v++) {
+      for (int u = 0; u < pw; u++) {
+        int fu = p->flip == FLIP_H ? pw - 1 - u : u;
+        int fv = p->flip == FLIP_V ? ph - 1 - v : v;
+        int cx, cy;
+        switch (p->rotation) {
+          case 90:  cx = ph - 1 - fv; cy = fu;          break;
+          case 180: cx = pw - 1 - fu; cy = ph - 1 - fv; break;
+          case 270: cx = fv;          cy = pw - 1 - fu; break;
+          default:  cx = fu;          cy = fv;          break;
+        }
+        int wx = slot_col * pw + u;
+        int wy = slot_row * ph + v;
+        gather[wy * width + wx] = (uint32_t)((p->y + cy) * width + p->x + cx);
+      }
+    }
+  }
+
+  for (int i = 0; i < width * height; i++)
+    if (gather[i] != (uint32_t)i) return 1;
+  return 0;
+}
+
+/*
+ * Compose the gather table with a nearest-neighbour scale from a
+ * `src_width` x `src_height` source, and mark the wire rows whose gather
+ * and colour-correction spans both match the row above.
+ */
+static void build_scaled(int src_width, int src_height, int width, int height) {
+  for (int i = 0; i < width * height; i++) {
+    int cx = (int)(gather[i] % (uint32_t)width);
+    int cy = (int)(gather[i] / (uint32_t)width);
+    scaled[i] = (uint32_t)((cy * src_height / height) * src_width + cx * src_width / width);
+  }
+  row_repeats[0] = 0;
+  for (int y = 1; y < height; y++) {
+    row_repeats[y] =
+      memcmp(&scaled[y * width], &scaled[(y - 1) * width], width * sizeof(scaled[0])) == 0 &&
+      span_count[y] == span_count[y - 1] &&
+      memcmp(spans[y], spans[y - 1], span_count[y] * sizeof(span_t)) == 0;
+  }
+  scaled_width = src_width;
+  scaled_height = src_height;
+}
+
+/*
+ * Reorder the overlay into wire order and find its runs. An overlay of
+ * another size than the sign (set before a geometry reload) is kept but
+ * left out until the size matches again. Returns the number of runs.
+ */
+static int build_overlay(void) {
+  const int width = prepared_width;
+  int total = 0;
+
+  memset(overlay_run_count, 0, sizeof(overlay_run_count));
+  overlay_total = 0;
+  if (overlay_width != prepared_width || overlay_height != prepared_height) return 0;
+
+  for (int y = 0; y < prepared_height; y++) {
+    int n = 0;
+    for (int x = 0; x < width; x++) {
+      const int i = y * width + x;
+      const uint32_t px = overlay_canvas[remap_active ? gather[i] : (uint32_t)i];
+      overlay_wire[i] = px;
+      const uint32_t alpha = px >> 24;
+      if (alpha == 0) continue;
+      if (n == 0 || overlay_runs[y][n - 1].x1 != x) {
+        overlay_runs[y][n].x0 = (uint16_t)x;
+        overlay_runs[y][n].opaque = 1;
+        n++;
+      }
+      overlay_runs[y][n - 1].x1 = (uint16_t)(x + 1);
+      if (alpha != 255) overlay_runs[y][n - 1].opaque = 0;
+    }
+    overlay_run_count[y] = (uint16_t)n;
+    total += n;
+  }
+  overlay_total = total;
+  return total;
+}
+
+/** FPGA header of wire row `row` at `payload`, using the packed struct from socket.h. */
+static inline void write_header(uint8_t *payload, int row, int width) {
+  fpga_row_header_t *hdr = (fpga_row_header_t *)payload;
+  hdr->row         = row;
+  hdr->reserved_hi = 0;
+  hdr->reserved_lo = 0;
+  hdr->width_hi    = (width >> 8);
+  hdr->width_lo    = (width & 0xFF);
+  hdr->flags_1     = 0x08;
+  hdr->flags_2     = 0x88;
+}
+
+/** Blocked gather of one wire row into a contiguous BGRA scratch row. */
+static void gather_row(const uint8_t *bgra, const uint32_t *index, uint32_t *out, int n) {
+  for (int x = 0; x < n; x++)
+    memcpy(&out[x], bgra + (size_t)index[x] * BYTES_PER_PIXEL, BYTES_PER_PIXEL);
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/*
+ * Compile the panel layout into the gather table, then flatten the
+ * colour-correction rectangles into per-row spans of wire pixels (a
+ * remapped pixel is corrected by the region its canvas pixel is in).
+ * Called at startup and after every reload; the frame loop only reads
+ * the result.
+ */
+void convert_prepare(const sender_config_t *cfg) {
+  const int width = cfg->sign_width;
+  int8_t owner[CONFIG_MAX_WIDTH];
+
+  remap_active = build_gather(cfg);
+  scaled_width = scaled_height = 0;
+  prepared_width = cfg->sign_width;
+  prepared_height = cfg->sign_height;
+  build_overlay();
+  spans_plain = 1;
+
+  for (int i = 0; i < cfg->ccm_count; i++)
+    memcpy(matrices[i], cfg->ccm[i].m, sizeof(matrices[i]));
+
+  for (int y = 0; y < cfg->sign_height; y++) {
+    memset(owner, SPAN_PLAIN, sizeof(owner));
+    for (int x = 0; x < width; x++) {
+      int cx = gather[y * width + x] % width;
+      int cy = gather[y * width + x] / width;
+      for (int i = 0; i < cfg->ccm_count; i++) {
+        const ccm_region_t *r = &cfg->ccm[i];
+        if (cx >= r->x && cx < r->x + r->w && cy >= r->y && cy < r->y + r->h)
+          owner[x] = (int8_t)i;
+      }
+    }
+
+    int n = 0;
+    for (int x = 0; x < cfg->sign_width; x++) {
+      if (n == 0 || spans[y][n - 1].ccm != owner[x]) {
+        spans[y][n].x0 = (uint16_t)x;
+        spans[y][n].ccm = owner[x];
+        n++;
+      }
+      spans[y][n - 1].x1 = (uint16_t)(x + 1);
+    }
+    span_count[y] = (uint16_t)n;
+    if (n != 1 || spans[y][0].ccm != SPAN_PLAIN) spans_plain = 0;
+  }
+}
+
+/*
+ * Replace the overlay plane with `bgra` (`width` x `height`, straight
+ * alpha), or remove it with NULL. Called from the frame loop between
+ * conversions; the next frame is composited with it. Returns the number
+ * of non-transparent runs, 0 if nothing will be drawn.
+ */
+int convert_set_overlay(const uint8_t *bgra, int width, int height) {
+  if (bgra == NULL) {
+    overlay_width = overlay_height = 0;
+  } else {
+    memcpy(overlay_canvas, bgra, (size_t)width * height * BYTES_PER_PIXEL);
+    overlay_width = width;
+    overlay_height = height;
+  }
+  return build_overlay();
+}
+
+/*
+ * Convert a BGRA canvas of `src_width` x `src_height` (the sign's size,
+ * or smaller for nearest-neighbour upscaling) into row packets: for each
+ * wire row, the FPGA header followed by `width` RGB triplets, one packet
+ * every `row_stride` bytes of `frame_rows`.
+ */
+void convert_frame(const uint8_t *bgra, int src_width, int src_height,
+                   uint8_t *frame_rows, size_t row_stride, int width, int height) {
+  uint32_t scratch[CONFIG_MAX_WIDTH];
+  const int upscale = src_width != width || src_height != height;
+  if (upscale && (src_width != scaled_width || src_height != scaled_height))
+    build_scaled(src_width, src_height, width, height);
+
+  for (int row = 0; row < height; row++) {
+    uint8_t *payload = frame_rows + row * row_stride;
+    write_header(payload, row, width);
+
+    uint8_t *dst = payload + ROW_HEADER_SIZE;
+    if (upscale && row_repeats[row] && !overlay_run_count[row] && !overlay_run_count[row - 1]) {
+      memcpy(dst, dst - row_stride, (size_t)width * 3);
+      continue;
+    }
+
+    const uint8_t *src = bgra + (size_t)row * width * BYTES_PER_PIXEL;
+    if (upscale) {
+      gather_row(bgra, scaled + row * width, scratch, width);
+      src = (const uint8_t *)scratch;
+    } else if (remap_active) {
+      gather_row(bgra, gather + row * width, scratch, width);
+      src = (const uint8_t *)scratch;
+    }
+    if (overlay_run_count[row]) {
+      if (src != (const uint8_t *)scratch) memcpy(scratch, src, (size_t)width * BYTES_PER_PIXEL);
+      overlay_row((uint8_t *)scratch, row, width);
+      src = (const uint8_t *)scratch;
+    }
+
+    for (int s = 0; s < span_count[row]; s++) {
+      const span_t *sp = &spans[row][s];
+      int n = sp->x1 - sp->x0;
+      if (sp->ccm == SPAN_PLAIN)
+        convert_plain(src + sp->x0 * BYTES_PER_PIXEL, dst + sp->x0 * 3, n);
+      else
+        convert_ccm(src + sp->x0 * BYTES_PER_PIXEL, dst + sp->x0 * 3, n, matrices[sp->ccm]);
+    }
+  }
+}
+
+/*
+ * Whether convert_frame() would leave a full-size canvas's pixels as a
+ * straight BGRA → RGB swizzle, so a wire-format frame can be sent as is.
+ */
+int convert_is_passthrough(void) {
+  return !remap_active && spans_plain && overlay_total == 0;
+}
+
+/** Write the FPGA header of each of `height` rows, one every `row_stride` bytes. */
+void convert_write_headers(uint8_t *frame_rows, size_t row_stride, int width, int height) {
+  for (int row = 0; row < height; row++)
+    write_header(frame_rows + row * row_stride, row, width);
+}
+
+/*
+ * Unpack `height` rows of `width` RGB triplets, one every `row_stride`
+ * bytes of `rgb`, into an opaque BGRA canvas for convert_frame().
+ */
+void convert_unpack_wire(const uint8_t *rgb, size_t row_stride, int width, int height,
+                         uint8_t *bgra) {
+  for (int row = 0; row < height; row++) {
+    const uint8_t *src = rgb + row * row_stride;
+    for (int x = 0; x < width; x++) {
+      bgra[0] = src[2]; /* B */
+      bgra[1] = src[1]; /* G */
+      bgra[2] = src[0]; /* R */
+      bgra[3] = 255;
+      src += 3;
+      bgra += BYTES_PER_PIXEL;
+    }
+  }
+}
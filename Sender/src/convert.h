@@ -0,0 +1,38 @@
+/*
+ * convert.h — BGRA canvas → FPGA row packet conversion
+ *
+ * The player's canvas arrives as BGRA, one 32-bit pixel per canvas pixel.
+ * The FPGA wants one packet per scanline: a 7-byte fpga_row_header_t then
+ * packed RGB triplets. This module owns that transformation, including
+ * the per-panel colour-correction matrices from sender.conf.
+ *
+ * convert_prepare() compiles the config into per-row spans once (startup
+ * and reload); convert_frame() is the per-frame hot path and does no
+ * allocation or branching beyond one switch per span. It also takes a
+ * canvas smaller than the sign and upscales it by nearest neighbour,
+ * and composites the overlay plane set by convert_set_overlay().
+ */
+
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define BYTES_PER_PIXEL 4               /* BGRA from the player's canvas */
+
+// ── Public API ──────────────────────────────────────────────────────
+
+extern void convert_prepare(const sender_config_t *cfg);
+extern int  convert_set_overlay(const uint8_t *bgra, int width, int height);
+extern void convert_frame(const uint8_t *bgra, int src_width, int src_height,
+                          uint8_t *frame_rows, size_t row_stride, int width, int height);
+
+/* Wire-format frames (see frame.h) */
+extern int  convert_is_passthrough(void);
+extern void convert_write_headers(uint8_t *frame_rows, size_t row_stride, int width, int height);
+extern void convert_unpack_wire(const uint8_t *rgb, size_t row_stride, int width, int height,
+                                uint8_t *bgra);
+
+#endif /* CONVERT_H */
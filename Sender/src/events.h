@@ -0,0 +1,42 @@
+/*
+ * events.h — The frame loop's one place to block
+ *
+ * Everything the frame loop waits for goes through a single epoll set:
+ *
+ *   timerfd    the next wake-up (sleep phase before a deadline)
+ *   Redis fd   replies to the frame pipeline (frame arrival)
+ *   signalfd   SIGINT, SIGTERM, SIGHUP, SIGUSR1
+ *
+ * so a slot never sits in a blocking read: a frame that arrives late is
+ * taken as soon as it lands, a slot with no frame still commits on time,
+ * and a signal wakes the loop immediately instead of after a BLPOP.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+
+enum {
+  EVENT_TIMER  = 1 << 0,       /* The requested wake-up time was reached */
+  EVENT_REDIS  = 1 << 1,       /* The Redis fd is readable (or writable, if asked) */
+  EVENT_SIGNAL = 1 << 2,       /* One or more signals were delivered to the handler */
+};
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Block the handled signals and set up the epoll set. Call before any
+   thread is started, so every thread inherits the blocked mask. */
+extern int  events_open(void (*on_signal)(int signum));
+
+/* Watch `fd` for Redis traffic (-1 = none); `writable` also wakes on
+   POLLOUT, for a pipeline the socket couldn't take in one write. */
+extern void events_watch_redis(int fd, int writable);
+
+/* Sleep until `until_ns` (CLOCK_MONOTONIC) or the first event; 0 only
+   polls. Returns a mask of EVENT_*. */
+extern int  events_wait(int64_t until_ns);
+
+extern void events_close(void);
+
+#endif /* EVENTS_H */
@@ -0,0 +1,69 @@
+/*
+ * frame.h — Frame header on player:frames
+ *
+ * A frame on the Redis queue is either the bare BGRA canvas (width *
+ * height * 4 bytes, the original format) or this header followed by the
+ * canvas. The Sender tells them apart by length and magic, so old
+ * producers keep working unchanged.
+ *
+ * All fields are little-endian (the Pi and every producer we run are).
+ * pts_ns is on CLOCK_MONOTONIC — process.hrtime.bigint() in Node — so any
+ * process on the same machine can schedule frames for the same instant;
+ * the Sender commits each frame at the first slot at or after its PTS.
+ *
+ * A headed canvas may be smaller than the sign (say 160x32 on a 320x64
+ * sign); the Sender upscales it by nearest neighbour as it converts, so
+ * a producer can render and ship a quarter of the pixels.
+ *
+ * With FRAME_FLAG_WIRE the canvas is replaced by packet-ready rows: for
+ * each of `height` rows, FRAME_WIRE_HEADROOM bytes of room (Ethernet
+ * header, then fpga_row_header_t — contents ignored, the Sender writes
+ * both) followed by `width` RGB triplets, already in wire order:
+ *
+ *   row 0:  [14 eth][7 fpga][R G B R G B ...]   row 1:  [14 eth][7 fpga]...
+ *
+ * The Sender transmits each row straight from the received buffer. A
+ * wire frame is always the sign's size; if sender.conf has a panel
+ * remap, colour correction or an overlay is set, the Sender unpacks it
+ * and converts it like a canvas.
+ *
+ * With FRAME_FLAG_REPEAT there are no pixels, only the frame_id of an
+ * earlier frame to show again (a uint64 after the header, 40 bytes in
+ * all). The other fields are the ones that frame would have carried.
+ * The Sender re-latches the rows already on the panel, or converts the
+ * named frame again if something has changed since, like an overlay or
+ * a blend. It only knows the last frame with pixels it took off the
+ * queue. A marker naming any other frame holds whatever the panel shows.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_MAGIC      0x46503250u    /* "P2PF" */
+#define FRAME_VERSION    1
+
+/* flags */
+#define FRAME_FLAG_INTERPOLATE (1u << 0) /* Keyframe: blend the slots up to the next one (see blend.h) */
+#define FRAME_FLAG_WIRE        (1u << 1) /* Packet-ready RGB rows instead of a BGRA canvas */
+#define FRAME_FLAG_REPEAT      (1u << 2) /* No pixels: the frame_id of an earlier frame to repeat */
+
+#define FRAME_WIRE_HEADROOM    21        /* Ethernet header (14) + FPGA row header (7) */
+#define FRAME_WIRE_ROW_SIZE(width) (FRAME_WIRE_HEADROOM + (size_t)(width) * 3)
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;              /* FRAME_MAGIC */
+  uint16_t version;            /* FRAME_VERSION */
+  uint16_t header_size;        /* Bytes before the canvas (sizeof this struct) */
+  uint64_t frame_id;           /* Producer's sequence number, +1 per frame */
+  int64_t  pts_ns;             /* Presentation time, CLOCK_MONOTONIC; 0 = as soon as possible */
+  uint16_t width;              /* Canvas geometry, up to sender.conf's; smaller is upscaled */
+  uint16_t height;
+  uint32_t flags;              /* FRAME_FLAG_*, other bits reserved (0) */
+} frame_header_t;
+
+_Static_assert(sizeof(frame_header_t) == 32, "frame_header_t must stay 32 bytes");
+
+#endif /* FRAME_H */
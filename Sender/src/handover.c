@@ -0,0 +1,208 @@
+/*
+ * handover.c — Unix socket handover of the raw socket, frame and phase
+ *
+ * Deploying a new build used to mean `kill -9` and a cold start: Redis
+ * reconnect, socket reopen, and a gap on the panel. Instead the old
+ * process keeps an abstract-namespace listener open (no file to clean
+ * up, no permissions to get wrong) and polls it once per frame in the
+ * slack after a commit. See handover.h for the three-message protocol.
+ *
+ * Everything here runs outside the timing-critical path: accept4() on
+ * the non-blocking listener costs one syscall per frame when nobody is
+ * waiting, and the exchange itself only happens once per deploy.
+ */
+
+#define _GNU_SOURCE
+#include "handover.h"
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ── Internal constants ──────────────────────────────────────────────
+
+#define MSG_READY            'R'
+#define MSG_GO               'G'
+#define ACK_TIMEOUT_MS       50      /* Old side: successor must answer within this */
+#define STATE_TIMEOUT_S      3       /* New side: old side answers at its next boundary */
+
+// ── Module state ────────────────────────────────────────────────────
+
+static int listen_fd = -1;
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+/** Build an abstract-namespace address (leading NUL, no filesystem entry). */
+static socklen_t make_address(struct sockaddr_un *addr, const char *name) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  size_t len = strlen(name);
+  if (len > sizeof(addr->sun_path) - 2) len = sizeof(addr->sun_path) - 2;
+  memcpy(addr->sun_path + 1, name, len);
+  return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + len);
+}
+
+// ── Predecessor's arena ─────────────────────────────────────────────
+
+/** Map an arena memfd received from a predecessor. */
+uint8_t *handover_map_frame(int fd, size_t size) {
+  void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (buf == MAP_FAILED) {
+    perror("mmap");
+    return NULL;
+  }
+  return buf;
+}
+
+// ── Old process side ────────────────────────────────────────────────
+
+/** Start accepting successors on the abstract socket `name`. */
+int handover_listen(const char *name) {
+  struct sockaddr_un addr;
+  socklen_t addr_len = make_address(&addr, name);
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0) {
+    perror("handover socket");
+    return -1;
+  }
+  if (bind(listen_fd, (struct sockaddr *)&addr, addr_len) < 0 || listen(listen_fd, 1) < 0) {
+    fprintf(stderr, "Handover: cannot listen on @%s: %s\n", name, strerror(errno));
+    close(listen_fd);
+    listen_fd = -1;
+    return -1;
+  }
+  return 0;
+}
+
+void handover_close(void) {
+  if (listen_fd >= 0) close(listen_fd);
+  listen_fd = -1;
+}
+
+/**
+ * Called once per frame boundary. Returns a connection fd if a successor
+ * is waiting, -1 otherwise (one non-blocking accept4, nothing else).
+ */
+int handover_poll(void) {
+  if (listen_fd < 0) return -1;
+  return accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+}
+
+/*
+ * Send a waiting successor our state and fds, wait briefly for READY,
+ * then release the listener and send GO. Returns 1 if the successor now
+ * owns the sign (the caller must stop without committing again), 0 if
+ * the exchange failed and we carry on. Always closes `conn`.
+ */
+int handover_offer(int conn, const handover_state_t *state, int sock_fd, int frame_fd) {
+  int fds[2] = { sock_fd, frame_fd };
+  char control[CMSG_SPACE(sizeof(fds))];
+  memset(control, 0, sizeof(control));
+
+  struct iovec iov = { .iov_base = (void *)state, .iov_len = sizeof(*state) };
+  struct msghdr msg = {
+    .msg_iov = &iov,
+    .msg_iovlen = 1,
+    .msg_control = control,
+    .msg_controllen = sizeof(control),
+  };
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  if (sendmsg(conn, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(*state)) {
+    perror("handover sendmsg");
+    close(conn);
+    return 0;
+  }
+
+  char ack = 0;
+  struct pollfd pfd = { .fd = conn, .events = POLLIN };
+  if (poll(&pfd, 1, ACK_TIMEOUT_MS) != 1 || read(conn, &ack, 1) != 1 || ack != MSG_READY) {
+    fprintf(stderr, "Handover: successor did not answer, keeping the sign\n");
+    close(conn);
+    return 0;
+  }
+
+  /* Free the name so the successor can listen for the next deploy. */
+  handover_close();
+
+  char go = MSG_GO;
+  ssize_t sent = send(conn, &go, 1, MSG_NOSIGNAL);
+  close(conn);
+  return sent == 1;
+}
+
+// ── New process side ────────────────────────────────────────────────
+
+/*
+ * Try to take over from a running Sender. Returns 1 with `state` and both
+ * fds filled in on success, 0 if no predecessor is listening (cold start),
+ * -1 if a predecessor exists but the exchange failed — it then keeps the
+ * sign and this process must not touch it.
+ */
+int handover_receive(const char *name, handover_state_t *state, int *sock_fd, int *frame_fd) {
+  struct sockaddr_un addr;
+  socklen_t addr_len = make_address(&addr, name);
+
+  int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (conn < 0) {
+    perror("handover socket");
+    return 0;
+  }
+  if (connect(conn, (struct sockaddr *)&addr, addr_len) < 0) {
+    close(conn);
+    return 0;                                   /* Nobody listening: cold start */
+  }
+
+  struct timeval tv = { .tv_sec = STATE_TIMEOUT_S, .tv_usec = 0 };
+  setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  int fds[2] = { -1, -1 };
+  char control[CMSG_SPACE(sizeof(fds))];
+  struct iovec iov = { .iov_base = state, .iov_len = sizeof(*state) };
+  struct msghdr msg = {
+    .msg_iov = &iov,
+    .msg_iovlen = 1,
+    .msg_control = control,
+    .msg_controllen = sizeof(control),
+  };
+
+  ssize_t got = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+      cmsg->cmsg_len == CMSG_LEN(sizeof(fds))) {
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  }
+
+  if (got != (ssize_t)sizeof(*state) || fds[0] < 0 || fds[1] < 0 ||
+      state->magic != HANDOVER_MAGIC || state->version != HANDOVER_VERSION) {
+    fprintf(stderr, "Handover: bad state from predecessor\n");
+    goto fail;
+  }
+
+  char ready = MSG_READY, go = 0;
+  if (send(conn, &ready, 1, MSG_NOSIGNAL) != 1 || read(conn, &go, 1) != 1 || go != MSG_GO) {
+    fprintf(stderr, "Handover: predecessor aborted\n");
+    goto fail;
+  }
+
+  close(conn);
+  *sock_fd = fds[0];
+  *frame_fd = fds[1];
+  return 1;
+
+fail:
+  if (fds[0] >= 0) close(fds[0]);
+  if (fds[1] >= 0) close(fds[1]);
+  close(conn);
+  return -1;
+}
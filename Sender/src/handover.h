@@ -0,0 +1,57 @@
+/*
+ * handover.h — Zero-downtime handover between two Sender processes
+ *
+ * A running Sender listens on an abstract Unix socket. A freshly started
+ * Sender connects to it after it has already loaded its config and
+ * connected to Redis, so the only thing left to transfer is live state:
+ *
+ *   old → new   STATE  handover_state_t + SCM_RIGHTS [raw socket, arena memfd]
+ *   new → old   READY
+ *   old → new   GO     old stops before its next commit and exits
+ *
+ * The old process only services a waiting successor in the slack right
+ * after a frame commit, so the new one inherits a clean frame boundary
+ * and the deadline phase (CLOCK_MONOTONIC_RAW is system-wide, so the
+ * timestamp is meaningful across processes) and commits the next slot.
+ */
+
+#ifndef HANDOVER_H
+#define HANDOVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HANDOVER_MAGIC    0x50325048u   /* "P2PH" */
+#define HANDOVER_VERSION  2
+
+// ── Transferred state ───────────────────────────────────────────────
+
+typedef struct {
+  uint32_t  magic;
+  uint32_t  version;
+  int64_t   slot_sec;          /* Last frame boundary (CLOCK_MONOTONIC_RAW) */
+  int64_t   slot_nsec;
+  int32_t   width;             /* Geometry of the rows in the frame buffer */
+  int32_t   height;
+  int32_t   brightness;        /* Last wire brightness, -1 if none yet */
+  uint64_t  frame_hash;        /* Idle detection state (see sender.c) */
+  int32_t   repeat_count;
+  uint32_t  frame_size;        /* Bytes of row packets at the head of the arena memfd */
+} handover_state_t;
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Map a predecessor's arena memfd (see arena.h) to copy its rows. */
+extern uint8_t *handover_map_frame(int fd, size_t size);
+
+/* Old process side */
+extern int  handover_listen(const char *name);
+extern int  handover_poll(void);
+extern int  handover_offer(int conn, const handover_state_t *state, int sock_fd, int frame_fd);
+extern void handover_close(void);
+
+/* New process side */
+extern int  handover_receive(const char *name, handover_state_t *state,
+                             int *sock_fd, int *frame_fd);
+
+#endif /* HANDOVER_H */
@@ -0,0 +1,219 @@
+/*
+ * metrics.c — Metrics endpoint thread
+ *
+ * One connection at a time: accept, skim the request (whatever it is —
+ * curl, Prometheus, `nc`), answer with an HTTP/1.0 response holding the
+ * current values, close. A scrape every few seconds costs a few
+ * microseconds on some other core.
+ *
+ * During a handover both Senders briefly run; the newcomer can't bind
+ * until the old one exits, so binding is retried every second. A Unix
+ * socket left behind by a dead Sender (connect refused) is removed.
+ */
+
+#define _GNU_SOURCE
+#include "metrics.h"
+#include "thread.h"
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ── Internal constants ──────────────────────────────────────────────
+
+#define LISTEN_MAX_LEN       108      /* sun_path */
+#define REQUEST_TIMEOUT_S    1        /* Give up on a client that sends nothing */
+#define BIND_RETRY_S         1
+#define BODY_MAX             4096
+
+// ── Module state ────────────────────────────────────────────────────
+
+metrics_t metrics;
+
+static char listen_spec[LISTEN_MAX_LEN];
+
+// ── Exposition ──────────────────────────────────────────────────────
+
+static uint64_t get(const uint64_t *counter) { return __atomic_load_n(counter, __ATOMIC_RELAXED); }
+static int64_t  gauge(const int64_t *g) { return __atomic_load_n(g, __ATOMIC_RELAXED); }
+
+/** Render the Prometheus text format into `out`. Returns its length. */
+static int render(char *out, size_t size) {
+  return snprintf(out, size,
+    "# HELP sender_frames_committed_total Commit packets sent to the FPGA.\n"
+    "# TYPE sender_frames_committed_total counter\n"
+    "sender_frames_committed_total %llu\n"
+    "# HELP sender_underflow_slots_total Frame slots that passed with no frame ready in time.\n"
+    "# TYPE sender_underflow_slots_total counter\n"
+    "sender_underflow_slots_total %llu\n"
+    "# HELP sender_frames_dropped_total Frames popped but never shown.\n"
+    "# TYPE sender_frames_dropped_total counter\n"
+    "sender_frames_dropped_total{reason=\"live\"} %llu\n"
+    "sender_frames_dropped_total{reason=\"late\"} %llu\n"
+    "# HELP sender_packets_sent_total Row and commit packets sent.\n"
+    "# TYPE sender_packets_sent_total counter\n"
+    "sender_packets_sent_total %llu\n"
+    "# HELP sender_bytes_sent_total Bytes sent on the raw socket, Ethernet header included.\n"
+    "# TYPE sender_bytes_sent_total counter\n"
+    "sender_bytes_sent_total %llu\n"
+    "# HELP sender_send_errors_total Packets the raw socket refused.\n"
+    "# TYPE sender_send_errors_total counter\n"
+    "sender_send_errors_total %llu\n"
+    "# HELP sender_redis_reconnects_total Redis connections re-established.\n"
+    "# TYPE sender_redis_reconnects_total counter\n"
+    "sender_redis_reconnects_total{connection=\"frames\"} %llu\n"
+    "sender_redis_reconnects_total{connection=\"control\"} %llu\n"
+    "# HELP sender_convert_seconds Time spent converting canvases to row packets.\n"
+    "# TYPE sender_convert_seconds summary\n"
+    "sender_convert_seconds_sum %.9f\n"
+    "sender_convert_seconds_count %llu\n"
+    "# HELP sender_render_to_commit_seconds Render start (stream entry ID) to commit, stream transport.\n"
+    "# TYPE sender_render_to_commit_seconds summary\n"
+    "sender_render_to_commit_seconds_sum %.6f\n"
+    "sender_render_to_commit_seconds_count %llu\n"
+    "# HELP sender_queue_depth Frames waiting on the frame queue at the last pop.\n"
+    "# TYPE sender_queue_depth gauge\n"
+    "sender_queue_depth %lld\n"
+    "# HELP sender_brightness Brightness in the commit packet (after the LUT).\n"
+    "# TYPE sender_brightness gauge\n"
+    "sender_brightness %lld\n",
+    (unsigned long long)get(&metrics.frames_committed),
+    (unsigned long long)get(&metrics.underflow_slots),
+    (unsigned long long)get(&metrics.dropped_live),
+    (unsigned long long)get(&metrics.dropped_late),
+    (unsigned long long)get(&metrics.packets_sent),
+    (unsigned long long)get(&metrics.bytes_sent),
+    (unsigned long long)get(&metrics.send_errors),
+    (unsigned long long)get(&metrics.redis_reconnects),
+    (unsigned long long)get(&metrics.control_reconnects),
+    get(&metrics.convert_ns) / 1e9,
+    (unsigned long long)get(&metrics.convert_count),
+    get(&metrics.render_commit_us) / 1e6,
+    (unsigned long long)get(&metrics.render_commit_count),
+    (long long)gauge(&metrics.queue_depth),
+    (long long)gauge(&metrics.brightness));
+}
+
+/** Answer one client and close it. */
+static void serve(int client) {
+  struct timeval tv = { .tv_sec = REQUEST_TIMEOUT_S };
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  /* Read until the blank line ending the request headers (or the client stops). */
+  char request[1024];
+  size_t got = 0;
+  for (;;) {
+    ssize_t n = recv(client, request + got, sizeof(request) - 1 - got, 0);
+    if (n <= 0) break;
+    got += (size_t)n;
+    request[got] = '\0';
+    if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n") || got == sizeof(request) - 1) break;
+  }
+
+  static char body[BODY_MAX];
+  static char response[BODY_MAX + 256];
+  int body_len = render(body, sizeof(body));
+  int len = snprintf(response, sizeof(response),
+                     "HTTP/1.0 200 OK\r\n"
+                     "Content-Type: text/plain; version=0.0.4\r\n"
+                     "Content-Length: %d\r\n"
+                     "\r\n%s", body_len, body);
+  for (int off = 0; off < len;) {
+    ssize_t n = send(client, response + off, (size_t)(len - off), MSG_NOSIGNAL);
+    if (n <= 0) break;
+    off += (int)n;
+  }
+  close(client);
+}
+
+// ── Listener ────────────────────────────────────────────────────────
+
+/** Is a live process accepting on this Unix socket? */
+static int unix_in_use(const struct sockaddr_un *addr) {
+  int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (probe < 0) return 1;
+  int alive = connect(probe, (const struct sockaddr *)addr, sizeof(*addr)) == 0;
+  close(probe);
+  return alive;
+}
+
+static int listen_unix(const char *path) {
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    int stale = errno == EADDRINUSE && !unix_in_use(&addr);
+    if (!stale || unlink(path) < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+      close(fd);
+      return -1;
+    }
+  }
+  if (listen(fd, 4) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int listen_tcp(const char *spec) {
+  char host[LISTEN_MAX_LEN];
+  strncpy(host, spec, sizeof(host) - 1);
+  host[sizeof(host) - 1] = '\0';
+  char *colon = strrchr(host, ':');
+  if (colon == NULL) return -1;
+  *colon = '\0';
+
+  struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = AI_PASSIVE };
+  struct addrinfo *res = NULL;
+  if (getaddrinfo(*host ? host : NULL, colon + 1, &hints, &res) != 0) return -1;
+
+  int fd = -1;
+  for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd < 0) continue;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) < 0 || listen(fd, 4) < 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+static void *metrics_main(void *arg) {
+  struct sched_param idle = { .sched_priority = 0 };
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &idle);
+
+  const int is_unix = strncmp(listen_spec, "unix:", 5) == 0;
+  int fd, warned = 0;
+  while ((fd = is_unix ? listen_unix(listen_spec + 5) : listen_tcp(listen_spec)) < 0) {
+    if (!warned++) fprintf(stderr, "Metrics: cannot listen on %s yet, retrying\n", listen_spec);
+    sleep(BIND_RETRY_S);
+  }
+  printf("Metrics: serving on %s\n", listen_spec);
+
+  for (;;) {
+    int client = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+    if (client >= 0) serve(client);
+  }
+  return NULL;
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+int metrics_start(const char *listen) {
+  if (strcmp(listen, "off") == 0) return 0;
+  strncpy(listen_spec, listen, sizeof(listen_spec) - 1);
+  return thread_start_background("sender-metrics", metrics_main, NULL);
+}
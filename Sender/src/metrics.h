@@ -0,0 +1,62 @@
+/*
+ * metrics.h — Prometheus metrics for the Sender
+ *
+ * The frame loop bumps plain counters in `metrics`; a background thread
+ * (off the frame loop's core, at SCHED_IDLE) serves them in Prometheus
+ * text format to anything that connects to `metrics_listen` in
+ * sender.conf — a TCP "host:port" or "unix:/path".
+ *
+ * Every field has exactly one writer, so an update is a relaxed load and
+ * store: no lock, no read-modify-write instruction, nothing that can
+ * stall a commit. The scraper's relaxed loads may see a value one update
+ * old, never a torn one.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+// ── Counters and gauges ─────────────────────────────────────────────
+
+typedef struct {
+  /* Frame loop */
+  uint64_t frames_committed;   /* Commit packets sent */
+  uint64_t underflow_slots;    /* Slots that passed with no frame ready in time */
+  uint64_t dropped_live;       /* Frames skipped by queue_policy = live */
+  uint64_t dropped_late;       /* Timestamped frames dropped past pts_late_ms */
+  uint64_t convert_ns;         /* Time spent in convert_frame() ... */
+  uint64_t convert_count;      /* ... over this many frames */
+  uint64_t redis_reconnects;   /* Frame connection re-established */
+  uint64_t render_commit_us;   /* Stream transport: render start → commit ... */
+  uint64_t render_commit_count;/* ... over this many frames */
+  int64_t  queue_depth;        /* Frame queue backlog at the last pop */
+  int64_t  brightness;         /* Wire brightness in the commit packet */
+
+  /* Transport (socket.c) */
+  uint64_t packets_sent;       /* Row + commit packets */
+  uint64_t bytes_sent;         /* Including the Ethernet header */
+  uint64_t send_errors;        /* Packets sendto()/sendmmsg() refused */
+
+  /* Control thread (control.c) */
+  uint64_t control_reconnects; /* Control connection re-established */
+} metrics_t;
+
+extern metrics_t metrics;
+
+/** Single-writer counter update. */
+static inline void metric_add(uint64_t *counter, uint64_t n) {
+  __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/** Single-writer gauge update. */
+static inline void metric_set(int64_t *gauge, int64_t value) {
+  __atomic_store_n(gauge, value, __ATOMIC_RELAXED);
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Start serving on `listen` ("host:port", "unix:/path"; "off" does nothing). */
+extern int metrics_start(const char *listen);
+
+#endif /* METRICS_H */
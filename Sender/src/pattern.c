@@ -0,0 +1,66 @@
+/*
+ * pattern.c — Test-pattern rendering
+ *
+ * Patterns are written as 32-bit BGRA words straight into the canvas the
+ * converter reads, one pass per frame. The whole canvas is at most
+ * 480x256 pixels, so even the busiest pattern costs a few microseconds.
+ */
+
+#include "pattern.h"
+#include <string.h>
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+/** One canvas pixel: BGRA in memory, i.e. 0xAARRGGBB as a little-endian word. */
+static inline uint32_t bgra(uint32_t r, uint32_t g, uint32_t b) {
+  return 0xFF000000u | (r & 0xFF) << 16 | (g & 0xFF) << 8 | (b & 0xFF);
+}
+
+/* SMPTE-style bar order: white, yellow, cyan, green, magenta, red, blue, black. */
+static const uint32_t BAR_COLORS[8] = {
+  0xFFFFFFFF, 0xFFFFFF00, 0xFF00FFFF, 0xFF00FF00,
+  0xFFFF00FF, 0xFFFF0000, 0xFF0000FF, 0xFF000000,
+};
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/** Render pattern `cfg->pattern` for frame number `frame` into `bgra`. */
+void pattern_render(const sender_config_t *cfg, uint32_t frame, uint8_t *bgra_out) {
+  const int width = cfg->sign_width;
+  const int height = cfg->sign_height;
+  const int bar_width = width >= 8 ? width / 8 : 1;
+  const uint32_t phase = (frame / (uint32_t)cfg->fps) & 1;
+
+  for (int y = 0; y < height; y++) {
+    uint32_t row[CONFIG_MAX_WIDTH];
+    for (int x = 0; x < width; x++) {
+      uint32_t px;
+      switch (cfg->pattern) {
+        case PATTERN_SOLID:
+          px = 0xFF000000u | cfg->pattern_color;
+          break;
+        case PATTERN_GRADIENT:
+          px = bgra(width > 1 ? x * 255 / (width - 1) : 0,
+                    height > 1 ? y * 255 / (height - 1) : 0, frame);
+          break;
+        case PATTERN_BARS:
+          px = BAR_COLORS[((x + frame) / bar_width) % 8];
+          break;
+        case PATTERN_CHECKER:
+          px = (((x >> 3) ^ (y >> 3) ^ phase) & 1) ? 0xFFFFFFFF : 0xFF000000;
+          break;
+        case PATTERN_ROWS:
+          px = bgra(y, 255 - y, 0x55);
+          break;
+        case PATTERN_COUNTER:
+          px = bgra(frame, frame >> 8, x + y);
+          break;
+        default:
+          px = 0xFF000000;
+          break;
+      }
+      row[x] = px;
+    }
+    memcpy(bgra_out + (size_t)y * width * sizeof(uint32_t), row, (size_t)width * sizeof(uint32_t));
+  }
+}
@@ -0,0 +1,28 @@
+/*
+ * pattern.h — Built-in test patterns for burn-in and benchmarking
+ *
+ * With `pattern` set in sender.conf the Sender stops popping Redis and
+ * renders a BGRA canvas itself each slot, then sends it through the normal
+ * conversion, remap and transport path. That makes it both a burn-in
+ * source and a self-contained benchmark of everything below the queue
+ * (`pattern_rate = max` drops the deadline wait entirely).
+ *
+ * Wire values (identity layout, no ccm) that the emulator can check:
+ *
+ *   rows     every pixel of row y is  R = y, G = 255 - y, B = 0x55
+ *   counter  pixel (x, y) of frame n is  R = n & 0xFF, G = (n >> 8) & 0xFF,
+ *            B = (x + y) & 0xFF — n increases by exactly one per frame
+ *            sent, so a gap in consecutive commits is a dropped frame
+ */
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "config.h"
+#include <stdint.h>
+
+// ── Public API ──────────────────────────────────────────────────────
+
+extern void pattern_render(const sender_config_t *cfg, uint32_t frame, uint8_t *bgra);
+
+#endif /* PATTERN_H */
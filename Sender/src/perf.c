@@ -0,0 +1,87 @@
+/*
+ * perf.c — perf_event_open() counters on the frame loop thread
+ *
+ * Each counter is its own event (no group), so a missing hardware event
+ * doesn't take the software one down with it. Kernel work is counted if
+ * the first attempt is allowed; otherwise the counter falls back to user
+ * space only and says so in the log.
+ */
+
+#include "perf.h"
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ── Counters ────────────────────────────────────────────────────────
+
+typedef struct {
+  const char *name;
+  uint32_t    type;
+  uint64_t    config;
+  int         fd;
+  int         user_only;       /* Kernel counting wasn't permitted */
+} counter_t;
+
+enum { CACHE_MISSES, DTLB_MISSES, PAGE_FAULTS, COUNTER_COUNT };
+
+static counter_t counters[COUNTER_COUNT] = {
+  [CACHE_MISSES] = { "cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1, 0 },
+  [DTLB_MISSES]  = { "dTLB misses", PERF_TYPE_HW_CACHE,
+                     PERF_COUNT_HW_CACHE_DTLB |
+                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), -1, 0 },
+  [PAGE_FAULTS]  = { "page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, -1, 0 },
+};
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+static int open_counter(uint32_t type, uint64_t config, int exclude_kernel) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = exclude_kernel;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1, -1, 0);
+}
+
+static int64_t read_counter(const counter_t *c) {
+  uint64_t value;
+  if (c->fd < 0 || read(c->fd, &value, sizeof(value)) != sizeof(value)) return -1;
+  return (int64_t)value;
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+void perf_open(void) {
+  char opened[128] = "";
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    counter_t *c = &counters[i];
+    c->fd = open_counter(c->type, c->config, 0);
+    if (c->fd < 0) {
+      c->fd = open_counter(c->type, c->config, 1);
+      c->user_only = c->fd >= 0;
+    }
+    if (c->fd < 0) continue;
+    size_t n = strlen(opened);
+    snprintf(opened + n, sizeof(opened) - n, "%s%s%s",
+             n ? ", " : "", c->name, c->user_only ? " (user only)" : "");
+  }
+  printf("Perf counters: %s\n", opened[0] ? opened : "unavailable");
+}
+
+void perf_read(perf_counts_t *out) {
+  out->cache_misses = read_counter(&counters[CACHE_MISSES]);
+  out->dtlb_misses = read_counter(&counters[DTLB_MISSES]);
+  out->page_faults = read_counter(&counters[PAGE_FAULTS]);
+}
+
+void perf_close(void) {
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    if (counters[i].fd >= 0) close(counters[i].fd);
+    counters[i].fd = -1;
+  }
+}
@@ -0,0 +1,40 @@
+/*
+ * perf.h — Hardware counters for the frame loop thread
+ *
+ * Cache misses and data-TLB misses per frame are the numbers that show
+ * whether the frame loop's buffers stay resident (see arena.h); page
+ * faults show whether anything is still being mapped in on the hot path.
+ * The counters are opened with perf_event_open() on the calling thread
+ * only, run all the time, and are read once per stats interval — no
+ * syscall per frame.
+ *
+ * Hardware events need a PMU the kernel exposes (not every VM does) and
+ * perf_event_paranoid <= 2; kernel-side counts (the socket copying the
+ * rows) are included when perf_event_paranoid allows it. A counter that
+ * can't be opened reads as -1 and prints as n/a.
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+
+// ── Counts ──────────────────────────────────────────────────────────
+
+typedef struct {
+  int64_t cache_misses;        /* Last-level cache misses, -1 = unavailable */
+  int64_t dtlb_misses;         /* Data-TLB load misses */
+  int64_t page_faults;         /* Minor + major page faults */
+} perf_counts_t;
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Open the counters for the calling thread and log which ones work. */
+extern void perf_open(void);
+
+/* Current totals since perf_open(). */
+extern void perf_read(perf_counts_t *out);
+
+extern void perf_close(void);
+
+#endif /* PERF_H */
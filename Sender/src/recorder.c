@@ -0,0 +1,132 @@
+/*
+ * recorder.c — Flight recorder ring and dump thread
+ *
+ * The ring is a static array indexed by slot number. A dump copies it to
+ * a second static array (256 KB, a few tens of microseconds in the slack
+ * after a commit) so the loop can keep recording while the thread
+ * formats and writes the copy at its leisure.
+ */
+
+#include "recorder.h"
+#include "thread.h"
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ── Module state ────────────────────────────────────────────────────
+
+static flight_record_t ring[RECORDER_FRAMES];
+static flight_record_t snapshot[RECORDER_FRAMES];
+static uint64_t next_slot = 0;         /* Slot the open record belongs to */
+static int      open = 0;
+
+static int      countdown = -1;        /* Slots until the requested dump, -1 = none */
+static const char *pending_reason = NULL;
+static uint64_t last_auto_slot = 0;    /* Slot of the last automatic dump */
+static int      busy = 0;              /* Dump thread is writing (atomic) */
+static sem_t    wake;
+
+/* Handed to the dump thread with the snapshot. */
+static uint64_t snapshot_end;         /* Slot after the newest record */
+static time_t   snapshot_time;
+static const char *snapshot_reason;
+static char     snapshot_dir[256];
+
+// ── Dump thread ─────────────────────────────────────────────────────
+
+static void write_dump(void) {
+  struct tm tm;
+  char stamp[32], path[320];
+  localtime_r(&snapshot_time, &tm);
+  strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+  snprintf(path, sizeof(path), "%s/flight-%s-%s.csv", snapshot_dir, stamp, snapshot_reason);
+
+  FILE *fp = fopen(path, "w");
+  if (fp == NULL) {
+    perror(path);
+    return;
+  }
+
+  /* Oldest first; times in microseconds from the oldest record's deadline. */
+  uint64_t first = snapshot_end > RECORDER_FRAMES ? snapshot_end - RECORDER_FRAMES : 0;
+  int64_t t0 = snapshot[first % RECORDER_FRAMES].deadline_ns;
+  fprintf(fp, "slot,start_us,ready_us,converted_us,sent_us,deadline_us,commit_us,"
+              "late_us,queue_depth,brightness,flags\n");
+  for (uint64_t s = first; s < snapshot_end; s++) {
+    const flight_record_t *r = &snapshot[s % RECORDER_FRAMES];
+#define US(ns) ((ns) ? ((ns) - t0) / 1e3 : 0.0)
+    fprintf(fp, "%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d,%s%s%s%s%s%s%s%s\n",
+            (unsigned long long)r->slot, US(r->start_ns), US(r->ready_ns), US(r->converted_ns),
+            US(r->sent_ns), US(r->deadline_ns), US(r->commit_ns),
+            r->commit_ns ? (r->commit_ns - r->deadline_ns) / 1e3 : 0.0,
+            r->queue_depth, r->brightness,
+            r->flags & REC_ROWS ? "R" : "", r->flags & REC_COMMIT ? "C" : "",
+            r->flags & REC_ROUND_TRIP ? "T" : "", r->flags & REC_IDLE ? "I" : "",
+            r->flags & REC_HELD ? "H" : "", r->flags & REC_UNDERFLOW ? "U" : "",
+            r->flags & REC_BLEND ? "B" : "", r->flags & REC_REPEAT ? "D" : "");
+#undef US
+  }
+  fclose(fp);
+  printf("Recorder: wrote %llu slots to %s\n",
+         (unsigned long long)(snapshot_end - first), path);
+}
+
+static void *recorder_main(void *arg) {
+  for (;;) {
+    while (sem_wait(&wake) != 0) {}
+    write_dump();
+    __atomic_store_n(&busy, 0, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+// ── Public API ──────────────────────────────────────────────────────
+
+int recorder_start(void) {
+  sem_init(&wake, 0, 0);
+  return thread_start_background("sender-recorder", recorder_main, NULL);
+}
+
+flight_record_t *recorder_open(int64_t now_ns) {
+  flight_record_t *r = &ring[next_slot % RECORDER_FRAMES];
+  if (!open) {
+    memset(r, 0, sizeof(*r));
+    r->slot = next_slot;
+    r->start_ns = now_ns;
+    open = 1;
+  }
+  return r;
+}
+
+void recorder_close(const char *dir) {
+  open = 0;
+  next_slot++;
+
+  if (countdown < 0) return;
+  if (countdown > 0) {
+    countdown--;
+    return;
+  }
+  if (__atomic_load_n(&busy, __ATOMIC_ACQUIRE)) return; /* Try again next slot */
+
+  memcpy(snapshot, ring, sizeof(ring));
+  snapshot_end = next_slot;
+  snapshot_time = time(NULL);
+  snapshot_reason = pending_reason;
+  snprintf(snapshot_dir, sizeof(snapshot_dir), "%s", dir);
+
+  countdown = -1;
+  __atomic_store_n(&busy, 1, __ATOMIC_RELAXED);
+  sem_post(&wake);
+}
+
+void recorder_request(const char *reason, int after) {
+  if (after > 0) {
+    if (countdown >= 0 || __atomic_load_n(&busy, __ATOMIC_ACQUIRE)) return;
+    if (last_auto_slot && next_slot - last_auto_slot < RECORDER_FRAMES) return;
+    last_auto_slot = next_slot;
+  }
+  pending_reason = reason;
+  countdown = after;
+}
@@ -0,0 +1,77 @@
+/*
+ * recorder.h — Flight recorder of per-slot timing
+ *
+ * The frame loop fills one flight_record_t per slot in a fixed ring
+ * (RECORDER_FRAMES deep, ~17 s at 240 FPS). Nothing is allocated and
+ * nothing is written out from the loop: a dump copies the ring at a frame
+ * boundary and hands the copy to a background thread, which writes it as
+ * CSV to `recorder_dir` (see sender.conf).
+ *
+ * Dumps happen on SIGUSR1 (./dump) and automatically when a commit is
+ * more than `recorder_miss_ms` late, RECORDER_POST_FRAMES slots after the
+ * miss so the aftermath is in the file too. `bin/timeline` renders a dump.
+ *
+ * All times are CLOCK_MONOTONIC_RAW in nanoseconds. One slot reads:
+ *
+ *   start → ready        getting the frame (batch, Redis round trip, pattern)
+ *   ready → converted    convert_frame()
+ *   converted → sent     row packets
+ *   sent → commit        waiting for the deadline (negative slack = late)
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+
+#define RECORDER_FRAMES       4096      /* Ring depth, power of two */
+#define RECORDER_POST_FRAMES  240       /* Slots recorded after a miss before dumping */
+
+// ── Records ─────────────────────────────────────────────────────────
+
+enum {
+  REC_ROWS       = 1 << 0,     /* Row packets went out this slot */
+  REC_COMMIT     = 1 << 1,     /* Commit packet went out this slot */
+  REC_ROUND_TRIP = 1 << 2,     /* The frame needed a Redis round trip */
+  REC_IDLE       = 1 << 3,     /* Static content: rows skipped */
+  REC_HELD       = 1 << 4,     /* Next frame not due yet (PTS) */
+  REC_UNDERFLOW  = 1 << 5,     /* No frame by the spin phase: the last one was re-latched */
+  REC_BLEND      = 1 << 6,     /* Rows are a blend of two keyframes */
+  REC_REPEAT     = 1 << 7,     /* Repeat marker: the frame before shown again */
+};
+
+typedef struct {
+  uint64_t slot;               /* Slot sequence number */
+  int64_t  start_ns;           /* Loop iteration began */
+  int64_t  ready_ns;           /* Frame in hand, conversion starts (0 = no rows) */
+  int64_t  converted_ns;       /* Conversion done, rows start */
+  int64_t  sent_ns;            /* Last row packet sent */
+  int64_t  deadline_ns;        /* The slot's commit deadline */
+  int64_t  commit_ns;          /* Commit packet sent (0 = no commit this slot) */
+  int32_t  queue_depth;        /* player:frames backlog at the last pop */
+  int16_t  brightness;         /* Wire brightness */
+  uint16_t flags;              /* REC_* */
+} flight_record_t;
+
+_Static_assert(sizeof(flight_record_t) == 64, "flight_record_t should fill one cache line");
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Start the dump thread. */
+extern int recorder_start(void);
+
+/* Record for the current slot. An iteration that ends without a slot (no
+   frame yet) keeps the same record open, so start_ns covers the wait. */
+extern flight_record_t *recorder_open(int64_t now_ns);
+
+/* Finish the current record; at a frame boundary, snapshot the ring to
+   `dir` if a dump is due. */
+extern void recorder_close(const char *dir);
+
+/* Ask for a dump after `after` more slots (0 = at this boundary, or as
+   soon as the previous dump is written). An automatic dump (after > 0)
+   is ignored while another is pending or being written, and until the
+   ring has turned over since the last one. */
+extern void recorder_request(const char *reason, int after);
+
+#endif /* RECORDER_H */
@@ -11,7 +11,7 @@
  * Achieving 240 FPS means each frame budget is ~4.167 ms. The timing loop uses
  * a hybrid sleep/spin-wait strategy:
  *
- *   1. If more than 200 us remain, usleep() for (remaining - 100 us).
+ *   1. If more than 200 us remain, sleep in epoll until (deadline - 100 us).
  *      This yields the CPU to the OS and avoids burning cycles needlessly.
  *
  *   2. For the final ~100-200 us, spin on CLOCK_MONOTONIC_RAW until the
@@ -22,6 +22,29 @@
  * compiled with -O3 -march=native -flto. It requires CAP_NET_RAW to open
  * the raw socket.
  *
+ * Runtime settings live in sender.conf (or the path given as argv[1]) and
+ * are re-read on SIGHUP. Timing and brightness changes take effect at the
+ * next frame boundary; interface, MAC and geometry changes reopen the
+ * socket in the slack right after a commit (see config.h).
+ *
+ * A new build started while an old one is running takes over instead of
+ * cold-starting: it receives the raw socket, the frame buffer and the
+ * deadline phase over a Unix socket and commits the very next slot
+ * (see handover.h).
+ *
+ * With `pattern` set in sender.conf, frames are rendered in place instead
+ * of popped from Redis (see pattern.h) — the frame connection isn't even
+ * opened until the pattern is switched off again.
+ *
+ * The loop never blocks anywhere but one epoll set (see events.h): the
+ * frame connection to Redis is non-blocking, so a frame that lands late
+ * is picked up the moment it arrives, a slot with no frame still commits
+ * on time, and SIGTERM or SIGHUP wake the loop at once.
+ *
+ * Brightness is not read per frame: a control thread off this core
+ * watches sender:brightness and the loop picks it up just before each
+ * commit (see control.h).
+ *
  * Protocol overview (see socket.c for packet construction):
  *   - 64 row packets   (EtherType 0x5500) — one per scanline, 7-byte header + RGB data
  *   - 1  frame packet  (EtherType 0x0107) — commit signal with brightness, triggers display
@@ -30,37 +53,115 @@
  *   Player (Node.js)  —RGBA buffer—>  Redis (BLPOP)  —>  sender  —raw Ethernet—>  FPGA
  */
 
+#include "arena.h"
+#include "blend.h"
+#include "config.h"
+#include "control.h"
+#include "convert.h"
+#include "events.h"
+#include "frame.h"
+#include "handover.h"
+#include "metrics.h"
+#include "pattern.h"
+#include "perf.h"
+#include "recorder.h"
 #include "socket.h"
+#include <errno.h>
 #include <hiredis/hiredis.h>
+#include <malloc.h>
+#include <math.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 
 // ── Constants ───────────────────────────────────────────────────────
 
 #define BILLION 1000000000L
-#define BYTES_PER_PIXEL 4              /* RGBA from the player's canvas */
-#define FPS 240                        /* Target refresh rate */
-#define FPS_SLEEP (1.0 / FPS)          /* ~4.167 ms frame budget */
-#define ROW_HEADER_SIZE 7              /* FPGA row header bytes (see fpga_row_header_t) */
 #define REDIS_BLPOP_KEY "player:frames"
+#define REDIS_STREAM_KEY "player:stream"
 #define REDIS_SOCKET "/var/run/redis/redis-server.sock"
-#define SENDER_BRIGHTNESS_KEY "sender:brightness"
-#define SIGN_WIDTH 320                 /* Pixels per row */
-#define SIGN_HEIGHT 64                 /* Rows (scanlines) */
-#define SLEEP_THRESHOLD_S 0.000200     /* Below this, spin-wait only (200 us) */
-#define SLEEP_MARGIN_S 0.000100        /* Wake early by this amount (100 us) */
+#define SENDER_CREDITS_KEY "sender:credits"
+#define SENDER_QUEUE_TARGET_KEY "sender:queue_target"
+#define SENDER_TRANSPORT_KEY "sender:transport"
+
+/*
+ * Live policy catch-up, atomic on the Redis side: take the newest frame,
+ * drop everything older, and ack each dropped frame with a "drop" token
+ * so the Director's credits stay balanced. Returns {dropped, frame}, or
+ * just {0} if the queue emptied meanwhile.
+ */
+#define DROP_TO_NEWEST_LUA                                                  \
+  "local n = redis.call('LLEN', KEYS[1]) "                                  \
+  "if n == 0 then return {0} end "                                          \
+  "local newest = redis.call('RPOP', KEYS[1]) "                             \
+  "redis.call('DEL', KEYS[1]) "                                             \
+  "for i = 2, n do redis.call('RPUSH', KEYS[2], 'drop') end "               \
+  "return {n - 1, newest}"
+
+/* The same on player:stream: keep the newest entry for XREAD to move past,
+   trim everything before it. Returns {dropped, [id, [field, frame]]}. */
+#define STREAM_TO_NEWEST_LUA                                                \
+  "local n = redis.call('XLEN', KEYS[1]) "                                  \
+  "if n == 0 then return {0} end "                                          \
+  "local newest = redis.call('XREVRANGE', KEYS[1], '+', '-', 'COUNT', 1)[1] " \
+  "redis.call('XTRIM', KEYS[1], 'MINID', newest[1]) "                       \
+  "for i = 2, n do redis.call('RPUSH', KEYS[2], 'drop') end "               \
+  "return {n - 1, newest}"
+
+/* Retained frame: every row packet of the last frame, sized for the largest
+   supported geometry so reloads never reallocate (and a successor can map it). */
+#define FRAME_BUFFER_SIZE (CONFIG_MAX_HEIGHT * (ROW_HEADER_SIZE + CONFIG_MAX_WIDTH * 3))
+#define CANVAS_SIZE       (CONFIG_MAX_WIDTH * CONFIG_MAX_HEIGHT * BYTES_PER_PIXEL)
+#define REDIS_READ_SIZE   (64 * 1024)     /* Socket reads staged for the reply reader */
+
+/* A wire-format frame (see frame.h) is kept and blended in a canvas buffer. */
+_Static_assert(CONFIG_MAX_HEIGHT * FRAME_WIRE_ROW_SIZE(CONFIG_MAX_WIDTH) <= CANVAS_SIZE,
+               "wire frames must fit the canvas buffers");
+
+/* The frame loop's buffers share one arena (see arena.h): the retained
+   rows first, where a successor looks for them, then three canvases
+   (keyframe, blend output, scratch) and the Redis read staging. */
+#define ARENA_SIZE (FRAME_BUFFER_SIZE + 3 * CANVAS_SIZE + REDIS_READ_SIZE + 5 * ARENA_ALIGN)
+
+/* Frame replies are ~80 KB mallocs inside hiredis. Keep freed ones in the
+   heap (no trimming, no per-reply mmap) so the next reply reuses resident
+   pages instead of faulting fresh ones in every frame. */
+#define MALLOC_TRIM_THRESHOLD (64 << 20)
+#define MALLOC_MMAP_THRESHOLD (16 << 20)
+
+// ── Configuration ───────────────────────────────────────────────────
+
+static sender_config_t config;         /* Active settings (see config.h) */
+static arena_t arena;                  /* Hot buffers, carved once at startup */
+static uint8_t *redis_rx;              /* REDIS_READ_SIZE, in the arena */
+static const char *config_path = CONFIG_DEFAULT_PATH;
 
 // ── Signal handling ─────────────────────────────────────────────────
 
 volatile sig_atomic_t running = 1;
+volatile sig_atomic_t reload_requested = 0;
+volatile sig_atomic_t dump_requested = 0;
 
 void sig_handler(int signum) { running = 0; }
 
+void reload_handler(int signum) { reload_requested = 1; }
+
+void dump_handler(int signum) { dump_requested = 1; }
+
+/** Dispatch a signal read from the event loop's signalfd (see events.h). */
+static void on_signal(int signum) {
+  if (signum == SIGHUP) reload_handler(signum);
+  else if (signum == SIGUSR1) dump_handler(signum);
+  else sig_handler(signum);
+}
+
 // ── Timing ──────────────────────────────────────────────────────────
 
 /** Returns elapsed time in seconds (nanosecond resolution). */
@@ -70,190 +171,1540 @@ double get_time_diff(struct timespec started_at, struct timespec ended_at) {
   return seconds + nanoseconds / (double)BILLION;
 }
 
+/** A timestamp as nanoseconds on its own clock. */
+static inline int64_t timespec_ns(struct timespec ts) {
+  return (int64_t)ts.tv_sec * BILLION + ts.tv_nsec;
+}
+
+static int64_t clock_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (int64_t)ts.tv_sec * BILLION + ts.tv_nsec;
+}
+
+/**
+ * CLOCK_MONOTONIC reading for a CLOCK_MONOTONIC_RAW time (PTS and timerfd
+ * use the former). The two drift apart while NTP slews, so the offset is
+ * sampled on every call.
+ */
+static int64_t raw_to_monotonic_ns(int64_t raw_ns) {
+  return raw_ns + clock_ns(CLOCK_MONOTONIC) - clock_ns(CLOCK_MONOTONIC_RAW);
+}
+
+/** Advance a timestamp by `seconds` (used to step a slot boundary without drift). */
+static void timespec_add(struct timespec *ts, double seconds) {
+  long ns = ts->tv_nsec + (long)(seconds * BILLION);
+  ts->tv_sec += ns / BILLION;
+  ts->tv_nsec = ns % BILLION;
+}
+
+// ── Adaptive refresh ────────────────────────────────────────────────
+// Static-content detection. Every popped frame is hashed; once the same
+// hash has been seen idle_after times in a row the Sender goes idle and
+// stops re-sending rows (see idle_mode_t in config.h). The first frame
+// with a different hash sends rows again in the same slot, so leaving
+// idle adds no latency.
+
+typedef enum { MODE_ACTIVE, MODE_IDLE, MODE_COUNT } refresh_mode_t;
+
+static const char *mode_names[MODE_COUNT] = { "active", "idle" };
+
+typedef struct {
+  uint64_t slots;                      /* Frame slots spent in this mode */
+  uint64_t wakeups;                    /* Times the event loop woke us (timer, frame or signal) */
+  uint64_t spins;                      /* Clock polls in the spin phase */
+  uint64_t packets;                    /* Row + commit packets sent */
+} mode_stats_t;
+
+static refresh_mode_t refresh_mode = MODE_ACTIVE;
+static mode_stats_t mode_stats[MODE_COUNT];
+static uint64_t last_frame_hash = 0;
+static int repeat_count = 0;
+static int wire_brightness = -1;       /* Last brightness handed to set_brightness() */
+static int brightness_changed = 0;     /* Forces a commit in a throttled idle slot */
+static int requested_brightness = -1;  /* sender:brightness via the control plane, -1 = unknown */
+static uint32_t control_seen = 0;      /* Control generation last picked up */
+static int overlay_note = -2;          /* Overlay change to log after the commit: runs, -1 cleared, -2 none */
+static uint32_t pattern_frame = 0;     /* Frame number for the built-in patterns */
+static uint8_t *scratch_canvas;        /* Test pattern or unpacked wire frame, CANVAS_SIZE, in the arena */
+static double convert_time_s = 0;      /* Conversion time this stats interval */
+static int convert_count = 0;          /* Frames converted this stats interval */
+static flight_record_t *flight = NULL; /* This slot's flight-recorder entry */
+static int rows_valid = 0;             /* The FPGA holds rows a commit can re-latch */
+
+/*
+ * Fast non-cryptographic 64-bit hash (multiply-xorshift). Four independent
+ * lanes over 32-byte blocks keep the multipliers busy; ~80 KB hashes in a
+ * few microseconds, well inside the frame budget.
+ */
+static uint64_t frame_hash(const uint8_t *data, size_t len) {
+  const uint64_t k = 0xFF51AFD7ED558CCDULL;
+  uint64_t h[4] = { len, ~len, len * k, ~len * k };
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    for (int lane = 0; lane < 4; lane++) {
+      uint64_t w;
+      memcpy(&w, data + i + lane * 8, 8);
+      h[lane] = (h[lane] ^ w) * k;
+      h[lane] ^= h[lane] >> 29;
+    }
+  }
+  uint64_t hash = h[0] ^ (h[1] * 3) ^ (h[2] * 5) ^ (h[3] * 7);
+  for (; i < len; i++) hash = (hash ^ data[i]) * 0x100000001B3ULL;
+  return hash ^ (hash >> 31);
+}
+
 // ── Redis ───────────────────────────────────────────────────────────
+// Two connections. The frame connection is non-blocking and carries only
+// the pop pipeline (see fetch_batch()): its replies are read as they land,
+// from the event loop (see events.h), so the frame loop never blocks on
+// Redis. The side connection is an ordinary blocking one for the rare
+// synchronous commands — the brightness default, requeueing and final
+// acks at handover or shutdown, INFO for the stats line, and CLIENT
+// UNBLOCK for a pop still parked server-side.
 
-/** Connect to Redis via Unix socket, retrying every second until success. */
-redisContext *connect_to_redis(const char *path) {
-  redisContext *c;
-  do {
-    c = redisConnectUnix(path);
-    if (c == NULL || c->err) {
-      if (c) {
-        fprintf(stderr, "ERROR: Redis connection: %s\n", c->errstr);
-        redisFree(c);
-      } else {
-        fprintf(stderr, "ERROR: Redis allocation.\n");
-      }
-      sleep(1);
+#define REDIS_RETRY_S          1       /* Between connection attempts */
+#define REDIS_SIDE_TIMEOUT_MS  100     /* Longest a side command may stall the loop */
+#define REDIS_SETTLE_MS        200     /* Wait for a reply on the frame connection outside the loop */
+
+static redisContext *side = NULL;      /* Blocking connection for everything but the pops */
+static long long frame_client_id = -1; /* CLIENT ID of the frame connection, for CLIENT UNBLOCK */
+static int64_t last_attempt_ns = 0;    /* Last connection attempt (CLOCK_MONOTONIC_RAW) */
+
+/** Connect to Redis via Unix socket. Returns NULL (after logging) on failure. */
+static redisContext *connect_to_redis(const char *path, int blocking) {
+  redisContext *c = blocking ? redisConnectUnix(path) : redisConnectUnixNonBlock(path);
+  if (c == NULL || c->err) {
+    if (c) {
+      fprintf(stderr, "ERROR: Redis connection: %s\n", c->errstr);
+      redisFree(c);
+    } else {
+      fprintf(stderr, "ERROR: Redis allocation.\n");
     }
-  } while (c == NULL || c->err);
+    return NULL;
+  }
+  /* The frame connection's reader buffer holds whole frames: never shrink it between them. */
+  if (!blocking) c->reader->maxbuf = 0;
   return c;
 }
 
-// ── Frame processing ────────────────────────────────────────────────
+/** Write as much of the pipeline as the socket takes; the rest goes out on EPOLLOUT. */
+static int redis_flush(redisContext *rc) {
+  int done = 0;
+  if (redisBufferWrite(rc, &done) != REDIS_OK) return -1;
+  events_watch_redis(rc->fd, !done);
+  return 0;
+}
+
+/** Feed everything the socket holds into the reply reader, without blocking. */
+static int redis_drain(redisContext *rc) {
+  for (;;) {
+    ssize_t n = read(rc->fd, redis_rx, REDIS_READ_SIZE);
+    if (n > 0) {
+      if (redisReaderFeed(rc->reader, (const char *)redis_rx, (size_t)n) != REDIS_OK) {
+        rc->err = REDIS_ERR_PROTOCOL;
+        snprintf(rc->errstr, sizeof(rc->errstr), "Reader buffer full");
+        return -1;
+      }
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    rc->err = n == 0 ? REDIS_ERR_EOF : REDIS_ERR_IO;
+    snprintf(rc->errstr, sizeof(rc->errstr), "%s",
+             n == 0 ? "Server closed the connection" : strerror(errno));
+    return -1;
+  }
+}
+
+/** Service the frame connection after the event loop flagged it. */
+static void redis_io(redisContext *rc) {
+  if (redis_flush(rc) < 0 || redis_drain(rc) < 0)
+    events_watch_redis(-1, 0);           /* Broken: stop the wake-ups, reconnect next slot */
+}
+
+/** Block up to `timeout_ms` for the next reply on the frame connection (setup only). */
+static redisReply *await_reply(redisContext *rc, int timeout_ms) {
+  const int64_t give_up_ns = clock_ns(CLOCK_MONOTONIC_RAW) + (int64_t)timeout_ms * 1000000;
+  for (;;) {
+    redisReply *r = NULL;
+    if (redis_flush(rc) < 0 || redis_drain(rc) < 0 ||
+        redisGetReply(rc, (void **)&r) != REDIS_OK) return NULL;
+    if (r) return r;
+    int64_t left_ns = give_up_ns - clock_ns(CLOCK_MONOTONIC_RAW);
+    if (left_ns <= 0) return NULL;
+    struct pollfd pfd = { .fd = rc->fd, .events = POLLIN };
+    poll(&pfd, 1, (int)(left_ns / 1000000) + 1);
+  }
+}
 
 /*
- * Pop one RGBA frame from Redis, convert to RGB row packets, and send all 64
- * rows to the FPGA. Returns 0 on success, -1 if no frame was available
- * or the connection broke.
- *
- * The two Redis commands are pipelined into a single round-trip:
- *   BLPOP player:frames 1   — blocks up to 1 s for the next frame
- *   GET sender:brightness    — non-blocking read of current brightness
+ * Frames popped but not yet sent. One round trip pops up to
+ * redis_batch_max frames with BLMPOP; the frame loop then drains them one
+ * per slot straight out of the reply, with no copy.
  */
-int process_and_send_frame(redisContext *rc, uint8_t *payload, size_t payload_len) {
-  redisAppendCommand(rc, "BLPOP %s %d", REDIS_BLPOP_KEY, 1);
-  redisAppendCommand(rc, "GET %s", SENDER_BRIGHTNESS_KEY);
+static redisReply *batch = NULL;       /* Reply owning the popped frames */
+static redisReply **batch_frames = NULL;
+static size_t batch_len = 0;
+static size_t batch_next = 0;          /* Next frame to send */
+static long queue_depth = 0;           /* LLEN after the last round trip */
+static uint64_t round_trips = 0;       /* Round trips this stats interval */
+static uint64_t frames_popped = 0;     /* Frames popped this stats interval */
+static uint64_t frames_dropped = 0;    /* Frames skipped by the live policy this stats interval */
+static double redis_cpu_s = -1;        /* Redis used_cpu_sys + used_cpu_user at the last report */
 
-  redisReply *rr_blpop = NULL;
-  redisReply *rr_brightness = NULL;
+/*
+ * The last frame with pixels taken off the queue (shown or dropped late):
+ * the one the repeat markers that follow it name (FRAME_FLAG_REPEAT, see
+ * frame.h). Its pixels stay in the reply they arrived in, which outlives
+ * its batch until a newer frame takes its place.
+ */
+typedef struct {
+  redisReply *reply;                   /* Owns the pixels; may still be the batch */
+  uint8_t    *src;                     /* Canvas or wire rows */
+  size_t      len;
+  uint64_t    frame_id;                /* 0 = none (a bare canvas can't be named) */
+  uint16_t    width;
+  uint16_t    height;
+  int         wire;
+  int         on_panel;                /* The FPGA holds exactly its rows */
+} repeat_base_t;
 
-  if (redisGetReply(rc, (void **)&rr_blpop) != REDIS_OK ||
-      redisGetReply(rc, (void **)&rr_brightness) != REDIS_OK) {
-    if (rr_blpop) freeReplyObject(rr_blpop);
-    if (rr_brightness) freeReplyObject(rr_brightness);
-    return -1;
+static repeat_base_t repeat_base;
+static uint64_t frames_repeated = 0;   /* Repeat markers taken this stats interval */
+static uint64_t repeats_unmatched = 0; /* ... naming a frame other than the base */
+
+/*
+ * The pipeline in flight on the frame connection. Its replies arrive in
+ * order — acks first, then the pop, then LLEN — and are read as far as
+ * they have landed each time the loop looks, so nothing waits for the
+ * slow one (a BLPOP parked on an empty queue).
+ */
+typedef enum { POP_SINGLE, POP_BATCH, POP_NEWEST, POP_STREAM, POP_STREAM_NEWEST } pop_kind_t;
+
+static int fetch_pending = 0;          /* A pipeline is in flight */
+static pop_kind_t fetch_kind;
+static int fetch_acks = 0;             /* Ack replies still to read */
+static int fetch_want_depth = 0;       /* LLEN reply follows the pop */
+static redisReply *fetch_pop = NULL;   /* Pop reply, held until LLEN arrives */
+
+/*
+ * Stream transport (transport = stream). XREAD keeps no cursor on the
+ * server, so the Sender reads after the last ID it has seen; entries
+ * leave the stream when the Sender is done with them — an XTRIM MINID
+ * rides along with the acks — so, like the list, the stream only ever
+ * holds frames nobody has taken yet, and a successor (or the next start)
+ * reads it from the head. Entry IDs are the render time in ms (see
+ * direct.ts), which gives each frame's age at commit.
+ */
+static redisReply *stream_frames[CONFIG_MAX_BATCH];  /* Frame value of each entry in the batch */
+static const char *stream_ids[CONFIG_MAX_BATCH];     /* Their IDs, owned by the batch reply */
+static char stream_cursor[32] = "0-0";               /* Last ID read */
+static char stream_consumed[32] = "0-0";             /* Last ID shown or dropped */
+static int stream_trim = 0;                          /* Trim through stream_consumed with the next acks */
+
+/** Whether the batch (and the pipeline in flight) came from player:stream. */
+static int stream_kind(void) {
+  return fetch_kind == POP_STREAM || fetch_kind == POP_STREAM_NEWEST;
+}
+
+/** Forget the pipeline in flight (its connection is being dropped). */
+static void reset_fetch(void) {
+  if (fetch_pop) freeReplyObject(fetch_pop);
+  fetch_pop = NULL;
+  fetch_pending = 0;
+  fetch_acks = 0;
+}
+
+/*
+ * Credit flow control. Every frame taken off the queue is acknowledged
+ * with a token on sender:credits carrying the wall-clock time (us) its
+ * rows went out. The Director keeps at most sender:queue_target frames in
+ * flight and renders only when an ack frees a credit, so the queue stays
+ * a few frames deep and the token times give it true end-to-end latency.
+ * Acks ride along with the next round trip, ahead of the pop. They are
+ * kept until the RPUSH's reply is read: if the connection breaks first,
+ * they go out again on the next one rather than costing the Director
+ * those credits for good.
+ */
+#define ACK_MAX (2 * CONFIG_MAX_BATCH)   /* A batch's acks awaiting their reply + the next batch's */
+
+static char ack_tokens[ACK_MAX][24];
+static int ack_count = 0;              /* Acks held, oldest first */
+static int ack_sent = 0;               /* The first ack_sent of them are in an RPUSH awaiting its reply */
+static int queue_target_dirty = 1;     /* Publish queue_target with the next round trip */
+
+/** The frame just taken from the batch is done with: trim it off the stream with the acks. */
+static void consume_entry(void) {
+  if (!stream_kind() || batch_next == 0) return;
+  snprintf(stream_consumed, sizeof(stream_consumed), "%s", stream_ids[batch_next - 1]);
+  stream_trim = 1;
+}
+
+/** Record that a frame left the queue (sent, skipped as idle, or rejected). */
+static void ack_frame(void) {
+  consume_entry();
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  if (ack_count < ACK_MAX)
+    snprintf(ack_tokens[ack_count++], sizeof(ack_tokens[0]), "%lld",
+             (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+/** Record that a frame left the queue without being shown. */
+static void ack_dropped(void) {
+  consume_entry();
+  if (ack_count < ACK_MAX)
+    snprintf(ack_tokens[ack_count++], sizeof(ack_tokens[0]), "drop");
+}
+
+/** The RPUSH carrying the first ack_sent acks got its reply: let them go. */
+static void confirm_acks(void) {
+  ack_count -= ack_sent;
+  memmove(ack_tokens, ack_tokens + ack_sent, (size_t)ack_count * sizeof(ack_tokens[0]));
+  ack_sent = 0;
+}
+
+/** Queue the pending acks, stream trim and (if changed) queue_target on the pipeline. Returns replies to read. */
+static int append_acks(redisContext *rc) {
+  int replies = 0;
+  if (queue_target_dirty) {
+    redisAppendCommand(rc, "SET %s %d", SENDER_QUEUE_TARGET_KEY, config.queue_target);
+    redisAppendCommand(rc, "SET %s %s", SENDER_TRANSPORT_KEY,
+                       config.transport == TRANSPORT_STREAM ? "stream" : "list");
+    queue_target_dirty = 0;
+    replies += 2;
+  }
+  if (stream_trim) {
+    /* MINID keeps IDs >= its argument: pass the ID right after the last one consumed. */
+    unsigned long long ms = 0, seq = 0;
+    sscanf(stream_consumed, "%llu-%llu", &ms, &seq);
+    redisAppendCommand(rc, "XTRIM %s MINID %llu-%llu", REDIS_STREAM_KEY, ms, seq + 1);
+    stream_trim = 0;
+    replies++;
+  }
+  if (ack_count > 0 && ack_sent == 0) {
+    const char *argv[2 + ACK_MAX];
+    argv[0] = "RPUSH";
+    argv[1] = SENDER_CREDITS_KEY;
+    for (int i = 0; i < ack_count; i++) argv[2 + i] = ack_tokens[i];
+    redisAppendCommandArgv(rc, 2 + ack_count, argv, NULL);
+    ack_sent = ack_count;
+    replies++;
   }
+  return replies;
+}
+
+/** Push pending acks now, on the side connection (before handover or shutdown). */
+static void flush_acks(void) {
+  if (side == NULL) return;
+  int n = append_acks(side);
+  for (; n > 0; n--) {
+    redisReply *r = NULL;
+    if (redisGetReply(side, (void **)&r) != REDIS_OK) break;
+    freeReplyObject(r);
+  }
+  if (n == 0) confirm_acks();
+  else ack_sent = 0;
+}
+
+static void release_batch(void) {
+  if (batch && batch != repeat_base.reply) freeReplyObject(batch);
+  batch = NULL;
+  batch_frames = NULL;
+  batch_len = batch_next = 0;
+}
 
-  /* Apply brightness from Redis (0-255), passed through to the frame commit packet. */
-  if (rr_brightness && rr_brightness->type == REDIS_REPLY_STRING) {
-    int brightness = atoi(rr_brightness->str);
-    if (brightness >= 0 && brightness <= 255) {
-      set_brightness(brightness);
+/*
+ * Push frames we popped but never sent back onto the head of the queue,
+ * in order, so a successor (or the next start) picks up where we stopped.
+ * Stream entries were never removed: rewinding the cursor is enough.
+ */
+static void requeue_batch(void) {
+  size_t left = batch_len - batch_next;
+  if (stream_kind()) {
+    snprintf(stream_cursor, sizeof(stream_cursor), "%s", stream_consumed);
+  } else if (side != NULL && left > 0) {
+    /* LPUSH inserts its arguments head-first, so pass them newest first. */
+    const char *argv[2 + CONFIG_MAX_BATCH];
+    size_t argvlen[2 + CONFIG_MAX_BATCH];
+    argv[0] = "LPUSH";
+    argvlen[0] = 5;
+    argv[1] = REDIS_BLPOP_KEY;
+    argvlen[1] = strlen(REDIS_BLPOP_KEY);
+    for (size_t i = 0; i < left; i++) {
+      redisReply *f = batch_frames[batch_len - 1 - i];
+      argv[2 + i] = f->str;
+      argvlen[2 + i] = f->len;
     }
+    redisReply *r = redisCommandArgv(side, (int)(2 + left), argv, argvlen);
+    if (r) freeReplyObject(r);
   }
-  if (rr_brightness) freeReplyObject(rr_brightness);
+  release_batch();
+}
 
-  /* No frame available (BLPOP timed out). */
-  if (!rr_blpop || rr_blpop->type == REDIS_REPLY_NIL) {
-    if (rr_blpop) freeReplyObject(rr_blpop);
-    return -1;
+/** Redis server CPU time (sys + user) in seconds from INFO cpu, or -1. */
+static double redis_cpu_seconds(redisContext *rc) {
+  redisReply *r = redisCommand(rc, "INFO cpu");
+  double total = -1;
+  if (r && r->type == REDIS_REPLY_STRING) {
+    const char *sys = strstr(r->str, "used_cpu_sys:");
+    const char *user = strstr(r->str, "used_cpu_user:");
+    if (sys && user) total = atof(sys + 13) + atof(user + 14);
+  }
+  if (r) freeReplyObject(r);
+  return total;
+}
+
+/*
+ * Open the side connection (defaulting brightness to max if no key exists
+ * yet), then the non-blocking frame connection. At most one attempt every
+ * REDIS_RETRY_S, so while Redis is down the loop keeps committing the
+ * retained frame. Returns the frame connection, or NULL.
+ */
+static redisContext *open_redis(void) {
+  int64_t now_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  if (last_attempt_ns && now_ns - last_attempt_ns < (int64_t)REDIS_RETRY_S * BILLION) return NULL;
+  last_attempt_ns = now_ns;
+
+  if (side && side->err) {
+    redisFree(side);
+    side = NULL;
+  }
+  if (side == NULL) {
+    side = connect_to_redis(REDIS_SOCKET, 1);
+    if (side == NULL) return NULL;
+    struct timeval tv = { .tv_sec = 0, .tv_usec = REDIS_SIDE_TIMEOUT_MS * 1000 };
+    redisSetTimeout(side, tv);
+    redisReply *rr_check = redisCommand(side, "GET %s", CONTROL_BRIGHTNESS_KEY);
+    if (!rr_check || rr_check->type == REDIS_REPLY_NIL) {
+      redisReply *rr_set = redisCommand(side, "SET %s %d", CONTROL_BRIGHTNESS_KEY, 255);
+      if (rr_set) freeReplyObject(rr_set);
+    }
+    if (rr_check) freeReplyObject(rr_check);
   }
 
-  const unsigned char *matrix_str = (const unsigned char *)rr_blpop->element[1]->str;
-  size_t matrix_len = rr_blpop->element[1]->len;
-  size_t expected_len = SIGN_WIDTH * SIGN_HEIGHT * BYTES_PER_PIXEL;
+  redisContext *rc = connect_to_redis(REDIS_SOCKET, 0);
+  if (rc == NULL) return NULL;
+  redisAppendCommand(rc, "CLIENT ID");
+  redisReply *r = await_reply(rc, REDIS_SETTLE_MS);
+  frame_client_id = r && r->type == REDIS_REPLY_INTEGER ? r->integer : -1;
+  if (r) freeReplyObject(r);
+  if (rc->err) {
+    fprintf(stderr, "ERROR: Redis connection: %s\n", rc->errstr);
+    events_watch_redis(-1, 0);
+    redisFree(rc);
+    return NULL;
+  }
+  return rc;
+}
 
-  if (matrix_len != expected_len) {
-    fprintf(stderr, "Invalid matrix: expected %zu, got %zu\n", expected_len, matrix_len);
-    freeReplyObject(rr_blpop);
-    return -1;
+/** Drop the frame connection along with anything half-read on it. */
+static void close_redis(redisContext *rc) {
+  events_watch_redis(-1, 0);
+  reset_fetch();
+  ack_sent = 0;                          /* Unconfirmed: push them again */
+  redisFree(rc);
+}
+
+// ── Presentation timestamps ─────────────────────────────────────────
+// Frames with a frame_header_t (see frame.h) carry a PTS on
+// CLOCK_MONOTONIC. A frame is committed at the first slot at or after its
+// PTS: an early frame stays at the head of the batch while the panel
+// keeps the previous one, and a frame whose slot passed more than
+// pts_late_ms ago is dropped in favour of the next. Frames without a PTS
+// are shown as soon as a slot is free, as before.
+
+#define PTS_EARLY_TOLERANCE_NS 200000  /* Commit jitter ignored when judging "at or after" */
+
+typedef struct {
+  uint64_t committed;                  /* Frames with a PTS that were committed */
+  double   error_sum_s;                /* Sum of (commit time - PTS) */
+  double   error_max_s;                /* Largest |commit time - PTS| */
+  uint64_t held;                       /* Slots that held an early frame back */
+  uint64_t blended;                    /* Slots that showed a blend of two keyframes */
+  double   blend_s;                    /* Time spent blending */
+  uint64_t late_drops;                 /* Frames dropped as irrecoverably late */
+  uint64_t id_gaps;                    /* Breaks in the frame_id sequence */
+} pts_stats_t;
+
+static pts_stats_t pts_stats;
+static int64_t pending_pts_ns = 0;     /* PTS of the rows sent this slot, 0 if none */
+static uint64_t last_frame_id = 0;
+
+/** Called right after a commit: score the frame it latched against its PTS. */
+static void record_pts_commit(void) {
+  if (pending_pts_ns == 0) return;
+  double error_s = (clock_ns(CLOCK_MONOTONIC) - pending_pts_ns) / (double)BILLION;
+  pts_stats.committed++;
+  pts_stats.error_sum_s += error_s;
+  if (fabs(error_s) > pts_stats.error_max_s) pts_stats.error_max_s = fabs(error_s);
+  pending_pts_ns = 0;
+}
+
+/** Print PTS error statistics for the last stats interval, then reset them. */
+static void print_pts_stats(void) {
+  pts_stats_t *ps = &pts_stats;
+  if (ps->committed || ps->held || ps->late_drops || ps->blended) {
+    printf("  pts    Error: %.1f us avg, %.1f us max | Held: %llu | Blended: %llu (%.1f us/frame)"
+           " | Late drops: %llu | ID gaps: %llu\n",
+           ps->committed ? ps->error_sum_s * 1e6 / ps->committed : 0.0, ps->error_max_s * 1e6,
+           (unsigned long long)ps->held, (unsigned long long)ps->blended,
+           ps->blended ? ps->blend_s * 1e6 / ps->blended : 0.0,
+           (unsigned long long)ps->late_drops, (unsigned long long)ps->id_gaps);
+  }
+  memset(ps, 0, sizeof(*ps));
+}
+
+static perf_counts_t perf_last;        /* Counter totals at the last stats line */
+
+/** Format one counter's change per frame, or n/a. */
+static const char *per_frame(char *buf, size_t size, int64_t now, int64_t then, int frames,
+                             const char *fmt) {
+  if (now < 0 || then < 0 || frames == 0) snprintf(buf, size, "n/a");
+  else snprintf(buf, size, fmt, (double)(now - then) / frames);
+  return buf;
+}
+
+/** Print cache, TLB and page-fault counts per frame for the last stats interval. */
+static void print_perf_stats(int frames) {
+  perf_counts_t now;
+  char cache[24], tlb[24], faults[24];
+  perf_read(&now);
+  printf("  perf   Cache misses/frame: %s | dTLB misses/frame: %s | Page faults/frame: %s\n",
+         per_frame(cache, sizeof(cache), now.cache_misses, perf_last.cache_misses, frames, "%.0f"),
+         per_frame(tlb, sizeof(tlb), now.dtlb_misses, perf_last.dtlb_misses, frames, "%.1f"),
+         per_frame(faults, sizeof(faults), now.page_faults, perf_last.page_faults, frames, "%.2f"));
+  perf_last = now;
+}
+
+// ── Stream latency ──────────────────────────────────────────────────
+// With transport = stream every frame's ID is its render start (ms, wall
+// clock), so each commit yields the frame's render-to-commit latency on
+// the Sender's own clock, independent of the Director's ack bookkeeping.
+// IDs are whole milliseconds: a figure reads up to 1 ms high.
+
+typedef struct {
+  uint64_t committed;                  /* Stream frames committed */
+  double   latency_sum_ms;
+  double   latency_max_ms;
+} stream_stats_t;
+
+static stream_stats_t stream_stats;
+static int64_t pending_render_ms = 0;  /* Render time of the rows sent this slot, 0 if none */
+
+/** Called right after a commit: how long ago the frame it latched started rendering. */
+static void record_stream_commit(void) {
+  if (pending_render_ms == 0) return;
+  const int64_t latency_us = clock_ns(CLOCK_REALTIME) / 1000 - pending_render_ms * 1000;
+  stream_stats.committed++;
+  stream_stats.latency_sum_ms += latency_us / 1000.0;
+  if (latency_us / 1000.0 > stream_stats.latency_max_ms) stream_stats.latency_max_ms = latency_us / 1000.0;
+  metric_add(&metrics.render_commit_us, latency_us > 0 ? (uint64_t)latency_us : 0);
+  metric_add(&metrics.render_commit_count, 1);
+  pending_render_ms = 0;
+}
+
+/** Print the stream position, lag and latency for the last stats interval, then reset them. */
+static void print_stream_stats(void) {
+  stream_stats_t *ss = &stream_stats;
+  if (config.transport == TRANSPORT_STREAM) {
+    printf("  stream Last ID: %s | Lag: %ld frames | Render→commit: %.1f ms avg, %.1f ms max\n",
+           stream_consumed, queue_depth,
+           ss->committed ? ss->latency_sum_ms / ss->committed : 0.0, ss->latency_max_ms);
   }
+  memset(ss, 0, sizeof(*ss));
+}
+
+// ── Temporal interpolation ──────────────────────────────────────────
+// A movie rendered below the panel rate sets FRAME_FLAG_INTERPOLATE on
+// its frames (see blend.h). Each one shown is kept as the current
+// keyframe; while the next is still early, its slots show a blend of the
+// two instead of holding the older one. The next keyframe has to be in
+// hand by then — the Director's PTS lead of queue_target frames sees to
+// that — and when it isn't, the slot re-latches as before.
+
+#define INTERP_MAX_GAP_NS 50000000     /* Keyframes further apart (a slip) are not blended */
+
+static uint8_t *keyframe;              /* CANVAS_SIZE, in the arena */
+static uint8_t *blended;               /* Blend output, CANVAS_SIZE, in the arena */
+static size_t keyframe_len = 0;        /* Canvas bytes in keyframe, 0 = none */
+static uint16_t keyframe_width = 0;    /* Canvas size, which may be below the sign's */
+static uint16_t keyframe_height = 0;
+static uint32_t keyframe_flags = 0;
+static uint64_t keyframe_id = 0;
+static int64_t keyframe_pts_ns = 0;
+
+/*
+ * Called for every frame shown: keep it if it's a keyframe, forget the
+ * last one if not. A NULL canvas (a repeat of the keyframe already kept)
+ * only moves the keyframe on to `hdr`'s ID and PTS.
+ */
+static void remember_keyframe(const frame_header_t *hdr, const uint8_t *canvas, size_t len) {
+  if (!(hdr->flags & FRAME_FLAG_INTERPOLATE) || hdr->pts_ns == 0) {
+    keyframe_len = 0;
+    return;
+  }
+  if (canvas) {
+    memcpy(keyframe, canvas, len);
+    keyframe_len = len;
+    keyframe_width = hdr->width;
+    keyframe_height = hdr->height;
+  }
+  keyframe_flags = hdr->flags;
+  keyframe_id = hdr->frame_id;
+  keyframe_pts_ns = hdr->pts_ns;
+}
+
+/*
+ * The canvas for a slot committing at `commit_ns`, between the current
+ * keyframe and `next` (not due yet). Returns NULL if `next` doesn't
+ * directly follow the current keyframe, in which case the slot holds.
+ */
+static uint8_t *interpolate(const frame_header_t *next, const uint8_t *canvas, size_t len,
+                            int64_t commit_ns) {
+  const int64_t gap_ns = next->pts_ns - keyframe_pts_ns;
+  if (!(next->flags & FRAME_FLAG_INTERPOLATE) || keyframe_len != len ||
+      next->width != keyframe_width || next->height != keyframe_height ||
+      ((next->flags ^ keyframe_flags) & FRAME_FLAG_WIRE) ||
+      next->frame_id != keyframe_id + 1 || gap_ns <= 0 || gap_ns > INTERP_MAX_GAP_NS)
+    return NULL;
+
+  int64_t weight = (commit_ns - keyframe_pts_ns) * BLEND_ONE / gap_ns;
+  if (weight <= 0) return NULL;
+  if (weight >= BLEND_ONE) weight = BLEND_ONE - 1;
+
+  struct timespec started, ended;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &started);
+  blend_frames(keyframe, canvas, blended, len, (int)weight);
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ended);
+  pts_stats.blended++;
+  pts_stats.blend_s += get_time_diff(started, ended);
+  flight->flags |= REC_BLEND;
+  return blended;
+}
+
+// ── Frame processing ────────────────────────────────────────────────
+
+/** Track the wire brightness so a throttled idle slot still commits a change. */
+static void apply_brightness(int level) {
+  if (level != wire_brightness) {
+    wire_brightness = level;
+    brightness_changed = 1;
+    metric_set(&metrics.brightness, level);
+  }
+  set_brightness(level);
+}
+
+/*
+ * Switch to a new overlay plane (see control.h). It must match the sign
+ * geometry; the next converted frame is composited with it, and a static
+ * frame counts as changed so idle mode sends it once more. The change is
+ * logged at the next frame boundary, not in the slot it lands in.
+ */
+static void apply_overlay(const uint8_t *bgra, size_t len) {
+  const size_t canvas_len = (size_t)config.sign_width * config.sign_height * BYTES_PER_PIXEL;
+  if (len != 0 && len != canvas_len) {
+    fprintf(stderr, "Overlay: ignored, expected %zu bytes (%dx%d BGRA), got %zu\n",
+            canvas_len, config.sign_width, config.sign_height, len);
+    return;
+  }
+  int runs = convert_set_overlay(len ? bgra : NULL, config.sign_width, config.sign_height);
+  overlay_note = len ? runs : -1;
+  last_frame_hash = 0;
+  repeat_count = 0;
+  repeat_base.on_panel = 0;
+}
+
+/*
+ * Pick up control-plane changes (see control.h). Called before the
+ * commit decision and again right before the commit itself, so a new
+ * level goes out in the very next commit packet. Only the first call
+ * (`take_overlay`) switches overlays: compositing one in is a full pass
+ * over the canvas, too slow for the commit window. A test pattern with
+ * no brightness known yet runs at the top of the LUT.
+ */
+static void poll_control(int take_overlay) {
+  control_values_t values;
+  const uint8_t *overlay;
+  size_t overlay_len;
+  if (control_read(&values, &control_seen)) requested_brightness = values.brightness;
+  if (take_overlay && control_take_overlay(&overlay, &overlay_len)) apply_overlay(overlay, overlay_len);
+  int level = requested_brightness;
+  if (level < 0 && config.pattern != PATTERN_OFF) level = 255;
+  if (level >= 0) apply_brightness(config.brightness_lut[level]);
+}
+
+/*
+ * Count a frame that is (`same`) or isn't the same as the one before
+ * toward idle_after. Returns 1 once the content has been static for long
+ * enough to go idle.
+ */
+static int count_static(int same) {
+  if (config.idle_mode != IDLE_OFF) {
+    if (!same) repeat_count = 0;
+    else if (repeat_count < config.idle_after) repeat_count++;
+    if (repeat_count >= config.idle_after) {
+      refresh_mode = MODE_IDLE;
+      flight->flags |= REC_IDLE;
+      return 1;
+    }
+  }
+  refresh_mode = MODE_ACTIVE;
+  return 0;
+}
+
+/*
+ * Static content: once a frame's `len` bytes have repeated idle_after
+ * times, its rows are skipped. Returns 1 if this frame is skipped.
+ */
+static int frame_is_idle(const uint8_t *data, size_t len) {
+  int same = 0;
+  if (config.idle_mode != IDLE_OFF) {
+    uint64_t hash = frame_hash(data, len);
+    same = hash == last_frame_hash;
+    last_frame_hash = hash;
+  }
+  return count_static(same);
+}
+
+/*
+ * Convert one BGRA canvas to row packets in `frame_rows` (one every
+ * `payload_len` bytes) and send them. Returns 0 if the rows were sent,
+ * 1 if the frame is static and the rows were skipped (idle).
+ */
+static int send_canvas(const uint8_t *bgra, int src_width, int src_height,
+                       uint8_t *frame_rows, size_t payload_len) {
+  const int width = config.sign_width;
+  const int height = config.sign_height;
+
+  if (frame_is_idle(bgra, (size_t)src_width * src_height * BYTES_PER_PIXEL)) return 1;
 
   /*
-   * Encode and transmit 64 row packets. Each row has a 7-byte FPGA
-   * header followed by 320 RGB triplets (960 bytes). The player's canvas
-   * stores pixels as BGRA, so we reorder to RGB here.
+   * Encode all row packets (64 by default), then transmit them. Each row
+   * has a 7-byte FPGA header followed by `width` RGB triplets (960 bytes
+   * by default); the player's canvas stores pixels as BGRA, so convert.c
+   * reorders them to RGB and applies any per-panel colour correction.
    */
-  const unsigned char *src = matrix_str;
-  for (int row = 0; row < SIGN_HEIGHT; row++) {
-    /* Build the FPGA row header using the packed struct from socket.h */
-    fpga_row_header_t *hdr = (fpga_row_header_t *)payload;
-    hdr->row         = row;
-    hdr->reserved_hi = 0;
-    hdr->reserved_lo = 0;
-    hdr->width_hi    = (SIGN_WIDTH >> 8);
-    hdr->width_lo    = (SIGN_WIDTH & 0xFF);
-    hdr->flags_1     = 0x08;
-    hdr->flags_2     = 0x88;
-
-    /* BGRA → RGB conversion, one pixel at a time */
-    uint8_t *pixel_data = payload + ROW_HEADER_SIZE;
-    for (int col = 0; col < SIGN_WIDTH; col++) {
-      *pixel_data++ = src[2]; /* R */
-      *pixel_data++ = src[1]; /* G */
-      *pixel_data++ = src[0]; /* B */
-      src += BYTES_PER_PIXEL;
-    }
-    send_row(payload, payload_len);
+  struct timespec convert_started, convert_ended;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &convert_started);
+  convert_frame(bgra, src_width, src_height, frame_rows, payload_len, width, height);
+  clock_gettime(CLOCK_MONOTONIC_RAW, &convert_ended);
+  double convert_s = get_time_diff(convert_started, convert_ended);
+  convert_time_s += convert_s;
+  convert_count++;
+  metric_add(&metrics.convert_ns, (uint64_t)(convert_s * BILLION));
+  metric_add(&metrics.convert_count, 1);
+
+  send_rows(frame_rows, payload_len, height, payload_len, 0);
+  flight->ready_ns = timespec_ns(convert_started);
+  flight->converted_ns = timespec_ns(convert_ended);
+  flight->sent_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  flight->flags |= REC_ROWS;
+  return 0;
+}
+
+/*
+ * Send a wire-format frame (see frame.h) of the sign's size straight from
+ * `rows`: fill in each row's headers and hand the rows to the socket, no
+ * conversion and no copy. `frame_rows` isn't updated — the FPGA already
+ * holds what a re-latch needs. A config that still has work to do on the
+ * pixels unpacks it into a canvas and converts that instead. Same return
+ * values as send_canvas().
+ */
+static int send_wire(uint8_t *rows, uint8_t *frame_rows, size_t payload_len) {
+  const int width = config.sign_width;
+  const int height = config.sign_height;
+  const size_t stride = FRAME_WIRE_ROW_SIZE(width);
+
+  if (!convert_is_passthrough()) {
+    convert_unpack_wire(rows + FRAME_WIRE_HEADROOM, stride, width, height, scratch_canvas);
+    return send_canvas(scratch_canvas, width, height, frame_rows, payload_len);
   }
+  if (frame_is_idle(rows, stride * height)) return 1;
+
+  struct timespec convert_started, convert_ended;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &convert_started);
+  convert_write_headers(rows + ETH_HEADER_SIZE, stride, width, height);
+  clock_gettime(CLOCK_MONOTONIC_RAW, &convert_ended);
+  double convert_s = get_time_diff(convert_started, convert_ended);
+  convert_time_s += convert_s;
+  convert_count++;
+  metric_add(&metrics.convert_ns, (uint64_t)(convert_s * BILLION));
+  metric_add(&metrics.convert_count, 1);
 
-  freeReplyObject(rr_blpop);
+  send_rows(rows, stride, height, payload_len, 1);
+  flight->ready_ns = timespec_ns(convert_started);
+  flight->converted_ns = timespec_ns(convert_ended);
+  flight->sent_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  flight->flags |= REC_ROWS;
   return 0;
 }
 
-// ── Main loop ───────────────────────────────────────────────────────
+/*
+ * Render the configured test pattern in place of a Redis frame. Same
+ * return values as send_canvas().
+ */
+static int render_and_send_frame(uint8_t *frame_rows, size_t payload_len) {
+  pattern_render(&config, pattern_frame++, scratch_canvas);
+  repeat_base.on_panel = 0;
+  return send_canvas(scratch_canvas, config.sign_width, config.sign_height, frame_rows, payload_len);
+}
+
+/*
+ * Make a frame with pixels, just shown or dropped late, the one repeat
+ * markers can name. The previous base's reply is freed unless it is
+ * still the batch.
+ */
+static void set_repeat_base(const frame_header_t *hdr, uint8_t *src, size_t len, int wire) {
+  if (repeat_base.reply && repeat_base.reply != batch) freeReplyObject(repeat_base.reply);
+  repeat_base = (repeat_base_t){
+    .reply    = batch,
+    .src      = src,
+    .len      = len,
+    .frame_id = hdr->magic ? hdr->frame_id : 0,
+    .width    = hdr->magic ? hdr->width : config.sign_width,
+    .height   = hdr->magic ? hdr->height : config.sign_height,
+    .wire     = wire,
+  };
+}
+
+/*
+ * Show a repeat marker: the frame it names again, if that is the repeat
+ * base. Rows already on the panel are just re-latched: no hash, no
+ * conversion, no packets. After an overlay change, a blend or a new link
+ * the base is converted again from its reply. A marker naming any other
+ * frame (dropped by the live policy, or popped by a predecessor) holds
+ * what the panel shows. Same return values as send_canvas().
+ */
+static int send_repeat(const frame_header_t *hdr, const uint8_t *payload,
+                       uint8_t *frame_rows, size_t payload_len) {
+  repeat_base_t *base = &repeat_base;
+  uint64_t frame_id;
+  memcpy(&frame_id, payload, sizeof(frame_id));
+  frames_repeated++;
+  flight->flags |= REC_REPEAT;
 
-int main() {
-  signal(SIGINT, sig_handler);
-  signal(SIGTERM, sig_handler);
+  if (frame_id == 0 || frame_id != base->frame_id) {
+    repeats_unmatched++;
+    keyframe_len = 0;
+    return 1;
+  }
+  if (base->on_panel) {
+    remember_keyframe(hdr, NULL, 0);
+    count_static(1);
+    return 1;
+  }
+  remember_keyframe(hdr, base->src, base->len);
+  int status = base->wire ? send_wire(base->src, frame_rows, payload_len)
+                          : send_canvas(base->src, base->width, base->height, frame_rows, payload_len);
+  base->on_panel = 1;
+  return status;
+}
 
-  redisContext *rc = connect_to_redis(REDIS_SOCKET);
+/*
+ * Point the batch at the frames in a stream reply — XREAD: [[key, [entry,
+ * ...]]], catch-up: [dropped, entry], entry = [id, [field, frame]] — and
+ * move the cursor past them. XLEN counted this batch; take it off the
+ * backlog.
+ */
+static void take_entries(redisReply *rr_pop) {
+  redisReply **entries = &rr_pop->element[1];
+  size_t count = 1;
+  if (fetch_kind == POP_STREAM) {
+    redisReply *key = rr_pop->element[0];
+    entries = key->type == REDIS_REPLY_ARRAY && key->elements == 2 ? key->element[1]->element : NULL;
+    count = entries ? key->element[1]->elements : 0;
+  }
 
-  /* Default brightness to max if no key exists yet. */
-  redisReply *rr_check = redisCommand(rc, "GET %s", SENDER_BRIGHTNESS_KEY);
-  if (!rr_check || rr_check->type == REDIS_REPLY_NIL) {
-    redisReply *rr_set = redisCommand(rc, "SET %s %d", SENDER_BRIGHTNESS_KEY, 255);
-    if (rr_set) freeReplyObject(rr_set);
+  batch_frames = stream_frames;
+  batch_len = 0;
+  for (size_t i = 0; i < count && i < CONFIG_MAX_BATCH; i++) {
+    redisReply *e = entries[i];
+    if (e->type != REDIS_REPLY_ARRAY || e->elements != 2 || e->element[0]->type != REDIS_REPLY_STRING)
+      continue;
+    snprintf(stream_cursor, sizeof(stream_cursor), "%s", e->element[0]->str);
+    redisReply *fields = e->element[1];
+    if (fields->type != REDIS_REPLY_ARRAY || fields->elements < 2) continue;
+    stream_ids[batch_len] = e->element[0]->str;
+    stream_frames[batch_len++] = fields->element[1];
   }
-  if (rr_check) freeReplyObject(rr_check);
+  queue_depth = queue_depth > (long)count ? queue_depth - (long)count : 0;
+  metric_set(&metrics.queue_depth, queue_depth);
+}
+
+/*
+ * Refill the local batch without blocking. When nothing is in flight the
+ * commands are pipelined into a single round trip, after any pending
+ * acks (see ack_frame()):
+ *   BLMPOP 1 1 player:frames LEFT COUNT n  — parks up to 1 s server-side, pops up to n
+ *   LLEN player:frames                     — backlog left behind
+ * and every call reads whatever replies have landed since.
+ *
+ * n follows the backlog: half of what was left last time, plus one, up to
+ * redis_batch_max. A shallow queue therefore still pops one frame per
+ * slot. With redis_batch_max = 1 this is a lone BLPOP (for Redis < 7).
+ *
+ * Under queue_policy = live, a backlog deeper than max_latency_ms swaps
+ * the pop for DROP_TO_NEWEST_LUA, and batches never exceed that bound.
+ *
+ * With transport = stream the same round trip reads player:stream:
+ *   XREAD COUNT n BLOCK 1000 STREAMS player:stream <last ID read>
+ *   XLEN player:stream                     — unread entries + this batch
+ * and STREAM_TO_NEWEST_LUA stands in for the live catch-up.
+ *
+ * Returns 0 if at least one frame was popped, -1 if the replies are still
+ * on their way, the pop came back empty, or the connection broke.
+ */
+static int fetch_batch(redisContext *rc) {
+  if (!fetch_pending) {
+    release_batch();
+    fetch_acks = append_acks(rc);
 
-  open_socket();
+    const int live = config.queue_policy == QUEUE_LIVE;
+    int bound = config.max_latency_ms * config.fps / 1000;
+    if (bound < 1) bound = 1;
 
-  /* Pre-allocate a reusable row buffer: 7-byte header + 320 pixels * 3 bytes RGB. */
-  const size_t payload_length = ROW_HEADER_SIZE + SIGN_WIDTH * 3;
-  uint8_t *payload = malloc(payload_length);
-  if (payload == NULL) {
-    fprintf(stderr, "Failed to allocate payload memory.\n");
-    redisFree(rc);
+    int count = (int)(queue_depth / 2 + 1);
+    if (count > config.redis_batch_max) count = config.redis_batch_max;
+    if (live && count > bound) count = bound;
+
+    const int stream = config.transport == TRANSPORT_STREAM;
+    if (stream) {
+      fetch_kind = live && queue_depth > bound ? POP_STREAM_NEWEST : POP_STREAM;
+      fetch_want_depth = 1;
+    } else {
+      fetch_kind = live && queue_depth > bound ? POP_NEWEST
+                 : config.redis_batch_max > 1  ? POP_BATCH : POP_SINGLE;
+      fetch_want_depth = live || config.redis_batch_max > 1;
+    }
+
+    if (fetch_kind == POP_STREAM_NEWEST)
+      redisAppendCommand(rc, "EVAL %s 2 %s %s", STREAM_TO_NEWEST_LUA, REDIS_STREAM_KEY, SENDER_CREDITS_KEY);
+    else if (fetch_kind == POP_STREAM)
+      redisAppendCommand(rc, "XREAD COUNT %d BLOCK 1000 STREAMS %s %s", count, REDIS_STREAM_KEY, stream_cursor);
+    else if (fetch_kind == POP_NEWEST)
+      redisAppendCommand(rc, "EVAL %s 2 %s %s", DROP_TO_NEWEST_LUA, REDIS_BLPOP_KEY, SENDER_CREDITS_KEY);
+    else if (fetch_kind == POP_BATCH)
+      redisAppendCommand(rc, "BLMPOP 1 1 %s LEFT COUNT %d", REDIS_BLPOP_KEY, count);
+    else
+      redisAppendCommand(rc, "BLPOP %s %d", REDIS_BLPOP_KEY, 1);
+    if (fetch_want_depth)
+      redisAppendCommand(rc, stream ? "XLEN %s" : "LLEN %s", stream ? REDIS_STREAM_KEY : REDIS_BLPOP_KEY);
+    fetch_pending = 1;
+  }
+
+  if (redis_flush(rc) < 0 || redis_drain(rc) < 0) return -1;
+
+  for (; fetch_acks > 0; fetch_acks--) {
+    redisReply *rr_ack = NULL;
+    if (redisGetReply(rc, (void **)&rr_ack) != REDIS_OK || rr_ack == NULL) return -1;
+    freeReplyObject(rr_ack);
+    if (fetch_acks == 1) confirm_acks();   /* The RPUSH is appended last */
+  }
+  if (fetch_pop == NULL &&
+      (redisGetReply(rc, (void **)&fetch_pop) != REDIS_OK || fetch_pop == NULL)) return -1;
+
+  redisReply *rr_pop = fetch_pop;
+  redisReply *rr_depth = NULL;
+  if (fetch_want_depth &&
+      (redisGetReply(rc, (void **)&rr_depth) != REDIS_OK || rr_depth == NULL)) return -1;
+  fetch_pop = NULL;
+  fetch_pending = 0;
+  round_trips++;
+
+  if (rr_depth && rr_depth->type == REDIS_REPLY_INTEGER) queue_depth = rr_depth->integer;
+  metric_set(&metrics.queue_depth, queue_depth);
+  if (rr_depth) freeReplyObject(rr_depth);
+
+  /* No frame available (timed out, emptied or unblocked), or an error such as BLMPOP on Redis < 7. */
+  if (rr_pop->type != REDIS_REPLY_ARRAY || rr_pop->elements != (fetch_kind == POP_STREAM ? 1 : 2)) {
+    if (rr_pop->type == REDIS_REPLY_ERROR)
+      fprintf(stderr, "ERROR: Redis pop: %s\n", rr_pop->str);
+    freeReplyObject(rr_pop);
+    queue_depth = 0;
+    metric_set(&metrics.queue_depth, 0);
+    return -1;
+  }
+
+  /* BLPOP: [key, frame]. BLMPOP: [key, [frame, ...]]. Live catch-up: [dropped, frame]. */
+  batch = rr_pop;
+  if (stream_kind()) {
+    take_entries(rr_pop);
+  } else if (fetch_kind == POP_BATCH) {
+    batch_frames = rr_pop->element[1]->element;
+    batch_len = rr_pop->element[1]->elements;
+  } else {
+    batch_frames = &rr_pop->element[1];
+    batch_len = 1;
+  }
+  if (fetch_kind == POP_NEWEST || fetch_kind == POP_STREAM_NEWEST) {
+    frames_dropped += rr_pop->element[0]->integer;
+    metric_add(&metrics.dropped_live, (uint64_t)rr_pop->element[0]->integer);
+  }
+  frames_popped += batch_len;
+  return batch_len > 0 ? 0 : -1;
+}
+
+/*
+ * Take the next RGBA frame (from the local batch, refilling it from Redis
+ * when empty), convert to RGB row packets, and send all 64 rows to the
+ * FPGA. Row packets are built in `frame_rows` (one every `payload_len`
+ * bytes) and left there as the retained last frame. `commit_at` is this
+ * slot's commit deadline, against which a frame's PTS is judged.
+ * Returns 0 if the rows were sent, 1 if the rows were skipped (static
+ * frame while idle, or the next frame isn't due yet), -1 if no frame was
+ * available or the connection broke.
+ */
+int process_and_send_frame(redisContext *rc, uint8_t *frame_rows, size_t payload_len,
+                           struct timespec commit_at) {
+  const size_t canvas_len = (size_t)config.sign_width * config.sign_height * BYTES_PER_PIXEL;
+  const int64_t commit_ns = raw_to_monotonic_ns(timespec_ns(commit_at));
+
+  for (;;) {
+    if (batch_next == batch_len && fetch_batch(rc) < 0) return -1;
+
+    redisReply *frame = batch_frames[batch_next];
+    uint8_t *canvas = (uint8_t *)frame->str;
+    frame_header_t hdr = { 0 };
+
+    /* A bare canvas is the sign's size; a header declares its own, up to the sign's. */
+    if (frame->len != canvas_len && frame->len >= sizeof(hdr)) {
+      memcpy(&hdr, frame->str, sizeof(hdr));
+      canvas += sizeof(hdr);
+    }
+    /* Wire rows are always the sign's size; a repeat marker carries only a frame ID. */
+    const int repeat = hdr.magic && (hdr.flags & FRAME_FLAG_REPEAT);
+    const int wire = hdr.magic && (hdr.flags & FRAME_FLAG_WIRE);
+    const size_t src_len = !hdr.magic ? canvas_len
+        : repeat ? sizeof(uint64_t)
+        : wire ? FRAME_WIRE_ROW_SIZE(hdr.width) * hdr.height
+        : (size_t)hdr.width * hdr.height * BYTES_PER_PIXEL;
+    if (hdr.magic ? (hdr.magic != FRAME_MAGIC || hdr.version != FRAME_VERSION ||
+                     hdr.header_size != sizeof(hdr) ||
+                     hdr.width == 0 || hdr.width > config.sign_width ||
+                     hdr.height == 0 || hdr.height > config.sign_height ||
+                     (wire && (hdr.width != config.sign_width || hdr.height != config.sign_height)) ||
+                     frame->len != sizeof(hdr) + src_len)
+                  : frame->len != canvas_len) {
+      fprintf(stderr, "Invalid matrix: expected %zu (+%zu header, a smaller canvas or wire rows), got %zu\n",
+              canvas_len, sizeof(hdr), frame->len);
+      batch_next++;
+      ack_frame();
+      continue;
+    }
+    const int src_width = hdr.magic ? hdr.width : config.sign_width;
+    const int src_height = hdr.magic ? hdr.height : config.sign_height;
+
+    if (hdr.pts_ns) {
+      /* Not due yet: keep it at the head, and blend toward it or re-latch the current frame. */
+      if (hdr.pts_ns > commit_ns + PTS_EARLY_TOLERANCE_NS) {
+        uint8_t *between = interpolate(&hdr, canvas, src_len, commit_ns);
+        if (between) repeat_base.on_panel = 0;
+        if (between && wire) return send_wire(between, frame_rows, payload_len);
+        if (between) return send_canvas(between, src_width, src_height, frame_rows, payload_len);
+        pts_stats.held++;
+        flight->flags |= REC_HELD;
+        return 1;
+      }
+      /* Its slot is long gone: showing it now would only delay the next one. */
+      if (commit_ns - hdr.pts_ns > (int64_t)config.pts_late_ms * 1000000) {
+        if (!repeat) set_repeat_base(&hdr, canvas, src_len, wire);
+        batch_next++;
+        ack_dropped();
+        pts_stats.late_drops++;
+        metric_add(&metrics.dropped_late, 1);
+        continue;
+      }
+    }
+
+    batch_next++;
+    if (hdr.magic) {
+      if (last_frame_id && hdr.frame_id != last_frame_id + 1) pts_stats.id_gaps++;
+      last_frame_id = hdr.frame_id;
+    }
+    pending_pts_ns = hdr.pts_ns;
+    pending_render_ms = stream_kind() ? strtoll(stream_ids[batch_next - 1], NULL, 10) : 0;
+    if (repeat) {
+      int status = send_repeat(&hdr, canvas, frame_rows, payload_len);
+      ack_frame();
+      return status;
+    }
+    remember_keyframe(&hdr, canvas, src_len);
+    set_repeat_base(&hdr, canvas, src_len, wire);
+
+    int status = wire ? send_wire(canvas, frame_rows, payload_len)
+                      : send_canvas(canvas, src_width, src_height, frame_rows, payload_len);
+    repeat_base.on_panel = 1;
+    ack_frame();
+    return status;
+  }
+}
+
+/*
+ * Bring an in-flight pop to rest before a handover, a shutdown or a
+ * switch to a test pattern: CLIENT UNBLOCK it from the side connection
+ * (a parked BLPOP then answers nil at once) and read its replies, so any
+ * frame it did pop lands in the batch for requeue_batch(). A pipeline
+ * that still hasn't answered is abandoned along with its connection.
+ */
+static void settle_fetch(redisContext **rc) {
+  if (*rc == NULL || !fetch_pending) return;
+  if (side && frame_client_id >= 0) {
+    redisReply *r = redisCommand(side, "CLIENT UNBLOCK %lld", frame_client_id);
+    if (r) freeReplyObject(r);
+  }
+
+  const int64_t give_up_ns = clock_ns(CLOCK_MONOTONIC_RAW) + (int64_t)REDIS_SETTLE_MS * 1000000;
+  while (fetch_batch(*rc) < 0 && fetch_pending && !(*rc)->err &&
+         clock_ns(CLOCK_MONOTONIC_RAW) < give_up_ns) {
+    struct pollfd pfd = { .fd = (*rc)->fd, .events = POLLIN };
+    poll(&pfd, 1, 1);
+  }
+  if (fetch_pending) {
+    close_redis(*rc);
+    *rc = NULL;
+  }
+}
+
+/*
+ * The frame for this slot, or -1 if none is ready yet: the test pattern
+ * if one is set, otherwise the next one from Redis (see
+ * process_and_send_frame()). A broken connection is dropped here and
+ * reopened on a later call.
+ */
+static int next_frame(redisContext **rc, uint8_t *frame_rows, size_t payload_len,
+                      struct timespec commit_at) {
+  if (config.pattern != PATTERN_OFF) {
+    if (batch || fetch_pending) {
+      settle_fetch(rc);
+      requeue_batch();
+    }
+    return render_and_send_frame(frame_rows, payload_len);
+  }
+
+  /* Transport switched by a reload: hand back what the old one popped first. */
+  if ((batch || fetch_pending) && stream_kind() != (config.transport == TRANSPORT_STREAM)) {
+    settle_fetch(rc);
+    requeue_batch();
+  }
+
+  if (*rc == NULL && (*rc = open_redis()) == NULL) return -1;
+  int status = process_and_send_frame(*rc, frame_rows, payload_len, commit_at);
+  if (status < 0 && (*rc)->err) {
+    fprintf(stderr, "ERROR: Redis connection: %s, reconnecting\n", (*rc)->errstr);
+    close_redis(*rc);
+    *rc = NULL;
+    metric_add(&metrics.redis_reconnects, 1);
+  }
+  return status;
+}
+
+// ── Frame pacing ────────────────────────────────────────────────────
+
+/*
+ * Hybrid wait: sleep in the event loop while there's enough remaining
+ * time for the kernel to wake us accurately, then spin-wait through the
+ * final microseconds. CLOCK_MONOTONIC_RAW is immune to NTP adjustments,
+ * giving us a stable reference that won't jump or smear. Replies landing
+ * on the frame connection meanwhile are read at once, so the next slot's
+ * frame is usually parsed before its slot begins.
+ *
+ * A slot that sends nothing (throttled idle) doesn't need precision: it
+ * sleeps once to the deadline and skips the spin, and the caller steps the
+ * slot boundary by exactly one budget so the cadence doesn't drift.
+ */
+static void wait_for_deadline(redisContext *rc, struct timespec slot_started, double budget_s,
+                              int precise, mode_stats_t *ms) {
+  struct timespec deadline = slot_started;
+  timespec_add(&deadline, budget_s);
+  const int64_t deadline_ns = timespec_ns(deadline);
+  const int64_t threshold_ns = precise ? (int64_t)(config.sleep_threshold_s * BILLION) : 0;
+  const int64_t wake_ns = deadline_ns - (precise ? (int64_t)(config.sleep_margin_s * BILLION) : 0);
+
+  /* Sleep phase: yield CPU while > 200 us remain, waking 100 us early. */
+  int64_t now_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  while (running && deadline_ns - now_ns > threshold_ns) {
+    if ((events_wait(raw_to_monotonic_ns(wake_ns)) & EVENT_REDIS) && rc) redis_io(rc);
+    ms->wakeups++;
+    now_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  }
+  if (!precise) return;
+
+  /* Spin phase: tight poll until the exact deadline. */
+  while (now_ns < deadline_ns) {
+    ms->spins++;
+    now_ns = clock_ns(CLOCK_MONOTONIC_RAW);
+  }
+}
+
+/**
+ * Report the gap between the last boundary before a reload or handover and
+ * the first one after it: every whole frame budget beyond the expected one
+ * is a frame the panel missed.
+ */
+static void report_missed(const char *what, struct timespec before, struct timespec after) {
+  double gap_s = get_time_diff(before, after);
+  long missed = lround(gap_s * config.fps) - 1;
+  if (missed < 0) missed = 0;
+  printf("%s: gap %.3f ms, missed %ld frame%s\n",
+         what, gap_s * 1e3, missed, missed == 1 ? "" : "s");
+}
+
+/** Print per-mode CPU/power-relevant rates for the last stats interval, then reset them. */
+static void print_mode_stats(double interval_s, int slots) {
+  for (int m = 0; m < MODE_COUNT; m++) {
+    mode_stats_t *ms = &mode_stats[m];
+    if (ms->slots == 0) continue;
+    double mode_s = interval_s * ms->slots / slots;
+    printf("  %-6s %5.1f%% | Wakeups/s: %.0f | Spins/s: %.0f | Packets/s: %.0f\n",
+           mode_names[m], 100.0 * ms->slots / slots,
+           ms->wakeups / mode_s, ms->spins / mode_s, ms->packets / mode_s);
+  }
+  memset(mode_stats, 0, sizeof(mode_stats));
+}
+
+/** Print round trips, frames per trip, live-policy drops, repeat markers and Redis CPU for the last stats interval, then reset them. */
+static void print_redis_stats(double interval_s) {
+  if (side == NULL) return;
+  double cpu_s = redis_cpu_seconds(side);
+  char cpu[32] = "n/a";
+  if (cpu_s >= 0 && redis_cpu_s >= 0)
+    snprintf(cpu, sizeof(cpu), "%.1f%%", 100.0 * (cpu_s - redis_cpu_s) / interval_s);
+  redis_cpu_s = cpu_s;
+  printf("  redis  Round trips/s: %.0f | Frames/trip: %.2f | Depth: %ld | Dropped: %llu"
+         " | Repeats: %llu (%llu unmatched) | CPU: %s\n",
+         round_trips / interval_s, round_trips ? (double)frames_popped / round_trips : 0.0,
+         queue_depth, (unsigned long long)frames_dropped,
+         (unsigned long long)frames_repeated, (unsigned long long)repeats_unmatched, cpu);
+  round_trips = 0;
+  frames_popped = 0;
+  frames_dropped = 0;
+  frames_repeated = 0;
+  repeats_unmatched = 0;
+}
+
+// ── Live reload ─────────────────────────────────────────────────────
+
+/** Row packet size for the current geometry: 7-byte header + width * 3 bytes RGB. */
+static size_t row_payload_length(const sender_config_t *cfg) {
+  return ROW_HEADER_SIZE + (size_t)cfg->sign_width * 3;
+}
+
+/*
+ * Re-read the config file after SIGHUP. Called right after a frame commit,
+ * so the whole frame budget is available before the next deadline.
+ *
+ * Non-disruptive settings are copied in place. Disruptive ones (interface,
+ * MAC, geometry) close and reopen the raw socket and switch the row length
+ * here, between two commits, so the FPGA never sees a half-switched frame.
+ * Returns 1 if a new config was applied, 0 if it was rejected.
+ */
+static int reload_config(size_t *payload_len) {
+  sender_config_t next;
+  if (config_load(config_path, &next) != 0) return 0;
+  queue_target_dirty = 1;
+
+  if (strcmp(config.handover_name, next.handover_name) != 0) {
+    handover_close();
+    handover_listen(next.handover_name);
+  }
+
+  if (!config_is_disruptive(&config, &next)) {
+    config = next;
+    convert_prepare(&config);
+    printf("Reload: applied %s\n", config_path);
     return 1;
   }
 
+  close_socket();
+  if (open_socket(next.nic_name, next.dest_mac) < 0) {
+    fprintf(stderr, "Reload: cannot open %s, reverting to %s\n", next.nic_name, config.nic_name);
+    if (open_socket(config.nic_name, config.dest_mac) < 0) {
+      fprintf(stderr, "Reload: cannot reopen %s either, exiting\n", config.nic_name);
+      exit(1);
+    }
+    return 0;
+  }
+  *payload_len = row_payload_length(&next);
+
+  /* New link or geometry: the FPGA holds nothing valid, so leave idle. */
+  last_frame_hash = 0;
+  repeat_count = 0;
+  rows_valid = 0;
+  repeat_base.on_panel = 0;
+  repeat_base.frame_id = 0;              /* It may not fit the new geometry */
+
+  printf("Reload: applied %s (interface %s, %dx%d)\n",
+         config_path, next.nic_name, next.sign_width, next.sign_height);
+  config = next;
+  convert_prepare(&config);
+  return 1;
+}
+
+/*
+ * Copy a predecessor's retained rows — the head of its arena memfd — into
+ * our own arena, then let its mapping go.
+ */
+static void adopt_rows(int fd, uint32_t size, uint8_t *frame_rows) {
+  struct stat st;
+  if (size == FRAME_BUFFER_SIZE && fstat(fd, &st) == 0 && st.st_size >= FRAME_BUFFER_SIZE) {
+    uint8_t *rows = handover_map_frame(fd, (size_t)st.st_size);
+    if (rows) {
+      memcpy(frame_rows, rows, FRAME_BUFFER_SIZE);
+      munmap(rows, (size_t)st.st_size);
+    }
+  }
+  close(fd);
+}
+
+// ── Main loop ───────────────────────────────────────────────────────
+
+int main(int argc, char **argv) {
+  /* Signals arrive through the event loop; block them before any thread starts. */
+  if (events_open(on_signal) < 0) return 1;
+
+  if (argc > 1) config_path = argv[1];
+  config_defaults(&config);
+  if (config_load(config_path, &config) != 0) {
+    fprintf(stderr, "Using built-in defaults.\n");
+  }
+  convert_prepare(&config);
+
+  /* Hot buffers: one pre-faulted arena, carved before anything touches Redis. */
+  mallopt(M_TRIM_THRESHOLD, MALLOC_TRIM_THRESHOLD);
+  mallopt(M_MMAP_THRESHOLD, MALLOC_MMAP_THRESHOLD);
+  if (arena_create(&arena, ARENA_SIZE) < 0) return 1;
+  uint8_t *frame_rows = arena_alloc(&arena, FRAME_BUFFER_SIZE);
+  keyframe = arena_alloc(&arena, CANVAS_SIZE);
+  blended = arena_alloc(&arena, CANVAS_SIZE);
+  scratch_canvas = arena_alloc(&arena, CANVAS_SIZE);
+  redis_rx = arena_alloc(&arena, REDIS_READ_SIZE);
+
+  /* A test pattern needs no Redis; it connects if the pattern is switched off.
+     With Redis down, the loop keeps retrying once a second. */
+  redisContext *rc = config.pattern == PATTERN_OFF ? open_redis() : NULL;
+  control_start(REDIS_SOCKET);
+  metrics_start(config.metrics_listen);
+  recorder_start();
+
   int sends = 0;
-  struct timespec start_time, send_started;
+  int idle_slot = 0;                     /* Slots since the last throttled idle commit */
+  int reload_pending = 0;                /* Report missed frames at the next commit */
+  int handover_pending = 0;
+  struct timespec start_time, send_started, reload_started, handover_started;
   clock_gettime(CLOCK_MONOTONIC_RAW, &start_time);
   clock_gettime(CLOCK_MONOTONIC_RAW, &send_started);
 
+  /*
+   * Redis is already connected (if up), so if an older Sender is running
+   * the only work left is to inherit its socket, frame buffer and phase. Otherwise
+   * cold start. A predecessor that refuses keeps the sign; we bow out.
+   */
+  size_t payload_length = row_payload_length(&config);
+  int frame_fd = -1;
+  int sock_fd = -1;
+  handover_state_t inherited;
+
+  /* Once we answer READY the predecessor exits: refuse up front what we couldn't drive. */
+  if (check_interface(config.nic_name) < 0) {
+    if (rc) redisFree(rc);
+    return 1;
+  }
+
+  int took_over = handover_receive(config.handover_name, &inherited, &sock_fd, &frame_fd);
+  if (took_over < 0) {
+    if (rc) redisFree(rc);
+    return 1;
+  }
+
+  if (took_over) {
+    if (adopt_socket(sock_fd, config.nic_name, config.dest_mac) < 0 &&
+        open_socket(config.nic_name, config.dest_mac) < 0) {
+      if (rc) redisFree(rc);
+      return 1;
+    }
+    adopt_rows(frame_fd, inherited.frame_size, frame_rows);
+
+    send_started.tv_sec = inherited.slot_sec;
+    send_started.tv_nsec = inherited.slot_nsec;
+    handover_started = send_started;
+    handover_pending = 1;
+    if (inherited.brightness >= 0) {
+      wire_brightness = inherited.brightness;
+      set_brightness(wire_brightness);
+    }
+    if (inherited.width == config.sign_width && inherited.height == config.sign_height) {
+      last_frame_hash = inherited.frame_hash;
+      repeat_count = inherited.repeat_count;
+    }
+    rows_valid = 1;
+    printf("Handover: took over from predecessor\n");
+  } else if (open_socket(config.nic_name, config.dest_mac) < 0) {
+    if (rc) redisFree(rc);
+    return 1;
+  }
+
+  handover_listen(config.handover_name);
+  perf_open();
+  perf_read(&perf_last);
+
   while (running) {
-    if (process_and_send_frame(rc, payload, payload_length) != 0) {
-      if (!running) break;
-      usleep(100); /* Queue empty — back off to avoid pegging the CPU. */
-      continue;
+    uint64_t trips_before = round_trips;
+    const double frame_budget_s = 1.0 / config.fps;
+    struct timespec commit_at = send_started;
+    timespec_add(&commit_at, frame_budget_s);
+    flight = recorder_open(clock_ns(CLOCK_MONOTONIC_RAW));
+
+    /*
+     * This slot's frame. While there is none, wait in the event loop up to
+     * the spin phase, taking a frame the moment it lands. A slot that gets
+     * none in time is an underflow: it re-latches the retained frame.
+     */
+    mode_stats_t *ms = &mode_stats[refresh_mode];
+    int status = next_frame(&rc, frame_rows, payload_length, commit_at);
+    const int64_t give_up_ns = timespec_ns(commit_at) - (int64_t)(config.sleep_threshold_s * BILLION);
+    while (status < 0 && running && clock_ns(CLOCK_MONOTONIC_RAW) < give_up_ns) {
+      events_wait(raw_to_monotonic_ns(give_up_ns));
+      ms->wakeups++;
+      status = next_frame(&rc, frame_rows, payload_length, commit_at);
+    }
+    if (!running) break;
+    if (status < 0) {
+      metric_add(&metrics.underflow_slots, 1);
+      flight->flags |= REC_UNDERFLOW;
+      status = 1;
     }
+    if (status == 0) rows_valid = 1;
+
+    ms = &mode_stats[refresh_mode];
+    ms->slots++;
+    if (status == 0) ms->packets += config.sign_height;
 
     /*
-     * Hybrid wait: sleep while there's enough remaining time for the kernel
-     * to wake us accurately, then spin-wait through the final microseconds.
-     * CLOCK_MONOTONIC_RAW is immune to NTP adjustments, giving us a stable
-     * reference that won't jump or smear.
+     * Throttled idle commits every (fps / idle_fps)-th slot. A brightness
+     * change still commits immediately since it lives in the commit packet.
      */
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
-    double elapsed_time_s = get_time_diff(send_started, now);
+    poll_control(1);
+    int commit = rows_valid;
+    if (commit && refresh_mode == MODE_IDLE && config.idle_mode == IDLE_THROTTLE) {
+      commit = brightness_changed || idle_slot % (config.fps / config.idle_fps) == 0;
+      idle_slot = commit ? 1 : idle_slot + 1;
+    } else {
+      idle_slot = 0;
+    }
 
-    while (elapsed_time_s < FPS_SLEEP) {
-      double remaining = FPS_SLEEP - elapsed_time_s;
+    /* pattern_rate = max: no pacing, commit as fast as the link allows. */
+    if (config.pattern == PATTERN_OFF || !config.pattern_unpaced)
+      wait_for_deadline(rc, send_started, frame_budget_s, commit, ms);
+    else
+      events_wait(0);                    /* Still take signals */
 
-      /* Sleep phase: yield CPU while > 200 us remain, waking 100 us early. */
-      if (remaining > SLEEP_THRESHOLD_S) {
-        useconds_t us = (useconds_t)((remaining - SLEEP_MARGIN_S) * 1e6);
-        if (us > 0) usleep(us);
-      }
+    if (commit) {
+      /* Mark the new frame boundary and tell the FPGA to latch the row data. */
+      clock_gettime(CLOCK_MONOTONIC_RAW, &send_started);
+      poll_control(0);
+      send_frame();
+      record_pts_commit();
+      record_stream_commit();
+      ms->packets++;
+      brightness_changed = 0;
+      metric_add(&metrics.frames_committed, 1);
+      flight->commit_ns = timespec_ns(send_started);
+      flight->flags |= REC_COMMIT;
+    } else {
+      timespec_add(&send_started, frame_budget_s);
+    }
 
-      /* Spin phase: tight poll until the exact deadline. */
-      clock_gettime(CLOCK_MONOTONIC_RAW, &now);
-      elapsed_time_s = get_time_diff(send_started, now);
+    flight->deadline_ns = timespec_ns(commit_at);
+    flight->queue_depth = (int32_t)queue_depth;
+    flight->brightness = (int16_t)wire_brightness;
+    if (round_trips != trips_before) flight->flags |= REC_ROUND_TRIP;
+    if (commit && config.recorder_miss_ms &&
+        flight->commit_ns - flight->deadline_ns > (int64_t)config.recorder_miss_ms * 1000000)
+      recorder_request("miss", RECORDER_POST_FRAMES);
+    if (dump_requested) {
+      dump_requested = 0;
+      recorder_request("manual", 0);
     }
+    recorder_close(config.recorder_dir);
 
-    /* Mark the new frame boundary and tell the FPGA to latch the row data. */
-    clock_gettime(CLOCK_MONOTONIC_RAW, &send_started);
-    send_frame();
+    /* First slot after a reload or handover: report what the panel missed. */
+    if (reload_pending) {
+      report_missed("Reload", reload_started, send_started);
+      reload_pending = 0;
+    }
+    if (handover_pending) {
+      report_missed("Handover", handover_started, send_started);
+      handover_pending = 0;
+    }
+    if (overlay_note != -2) {
+      if (overlay_note >= 0) printf("Overlay: set, %d runs\n", overlay_note);
+      else printf("Overlay: cleared\n");
+      overlay_note = -2;
+    }
 
-    /* Print actual FPS every 240 frames (once per second at target rate). */
+    /* Frame boundary: the rows are latched, so settings can change now. */
+    if (reload_requested) {
+      reload_requested = 0;
+      reload_started = send_started;
+      reload_pending = reload_config(&payload_length);
+    }
+
+    /* Frame boundary: a new build may be waiting to take over. */
+    int successor = handover_poll();
+    if (successor >= 0) {
+      settle_fetch(&rc);                 /* Nothing left parked on the frame connection */
+      requeue_batch();                   /* The successor pops these next */
+      flush_acks();
+      handover_state_t state = {
+        .magic        = HANDOVER_MAGIC,
+        .version      = HANDOVER_VERSION,
+        .slot_sec     = send_started.tv_sec,
+        .slot_nsec    = send_started.tv_nsec,
+        .width        = config.sign_width,
+        .height       = config.sign_height,
+        .brightness   = wire_brightness,
+        .frame_hash   = last_frame_hash,
+        .repeat_count = repeat_count,
+        .frame_size   = FRAME_BUFFER_SIZE,
+      };
+      if (handover_offer(successor, &state, socket_fd(), arena.fd)) {
+        printf("Handover: successor took over\n");
+        break;
+      }
+    }
+
+    /* Print actual FPS every stats_interval frames (once per second by default). */
     sends++;
-    if (sends % FPS == 0) {
+    if (sends % config.stats_interval == 0) {
       struct timespec current_time;
       clock_gettime(CLOCK_MONOTONIC_RAW, &current_time);
       double total_diff = get_time_diff(start_time, current_time);
-      printf("FPS: %d | Actual: %.4f\n", FPS, sends / total_diff);
+      printf("FPS: %d | Actual: %.4f | Convert: %.1f us/frame\n", config.fps, sends / total_diff,
+             convert_count ? convert_time_s * 1e6 / convert_count : 0.0);
+      convert_time_s = 0;
+      convert_count = 0;
+      print_mode_stats(total_diff, sends);
+      print_redis_stats(total_diff);
+      print_stream_stats();
+      print_pts_stats();
+      print_perf_stats(sends);
       clock_gettime(CLOCK_MONOTONIC_RAW, &start_time);
       sends = 0;
     }
   }
 
-  free(payload);
+  settle_fetch(&rc);
+  requeue_batch();
+  flush_acks();
+  handover_close();
+  arena_destroy(&arena);
   close_socket();
-  redisFree(rc);
+  if (rc) close_redis(rc);
+  if (side) redisFree(side);
+  events_close();
+  perf_close();
   printf("Sender shutdown.\n");
   return 0;
 }
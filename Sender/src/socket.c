@@ -3,7 +3,8 @@
  *
  * The FPGA receiver card is an FPGA-based LED controller commonly used in
  * large LED panels. It speaks a proprietary protocol over raw Ethernet (no IP).
- * This module opens an AF_PACKET raw socket on eth0 and builds Ethernet frames
+ * This module opens an AF_PACKET raw socket on the configured interface
+ * (eth0 by default) and builds Ethernet frames
  * by hand — source/destination MAC, EtherType, and payload.
  *
  * Two packet types drive the display:
@@ -17,32 +18,44 @@
  *     brightness values embedded at specific offsets. This tells the FPGA to
  *     latch the accumulated row data and push it to the LEDs.
  *
- * The destination MAC 11:22:33:44:55:66 is the FPGA receiver's default address.
+ * The destination MAC 11:22:33:44:55:66 is the FPGA receiver's default address;
+ * both it and the interface can be overridden in sender.conf.
  */
 
+#define _GNU_SOURCE
 #include "socket.h"
+#include "config.h"
+#include "metrics.h"
 #include <arpa/inet.h>
+#include <errno.h>
 #include <linux/if_packet.h>
 #include <net/if.h>
 #include <netinet/ether.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 // ── Internal constants ──────────────────────────────────────────────
 
 #define ETH_ALEN  6
 #define BUF_SIZ   1540                     /* Max Ethernet frame we'll build */
-#define NIC_NAME  "eth0"
 
 // ── Module state ────────────────────────────────────────────────────
 
 static int       fd;                       /* Raw socket file descriptor */
-static int       ifrindex;                 /* Interface index for eth0 */
+static int       ifrindex;                 /* Interface index of the FPGA NIC */
 static uint64_t  src_mac;                  /* Our MAC address (read from NIC) */
+static uint64_t  dst_mac;                  /* FPGA receiver MAC (from config) */
 static int       current_brightness = 0;
 static uint8_t   frame_data[FRAME_DATA_LENGTH] = {0}; /* Pre-zeroed frame commit template */
+static uint8_t   row_eth_header[ETH_HEADER_SIZE];     /* Ethernet header of every row packet */
+
+/* One frame's row packets for sendmmsg(), filled in place each frame. */
+static struct mmsghdr     row_msgs[CONFIG_MAX_HEIGHT];
+static struct iovec       row_iovs[CONFIG_MAX_HEIGHT][2];
+static struct sockaddr_ll row_address;
 
 // ── Helpers ─────────────────────────────────────────────────────────
 
@@ -67,24 +80,88 @@ void close_socket(void) {
   close(fd);
 }
 
-/** Open a raw AF_PACKET socket on eth0 and cache the interface index + MAC. */
-int open_socket(void) {
-  fd = socket(AF_PACKET, SOCK_RAW, IPPROTO_RAW);
+/**
+ * Use an already-open raw socket (e.g. inherited from a predecessor via
+ * handover.c) and cache the interface index + MAC for `nic_name`.
+ * `dest_mac` is the FPGA receiver address used for every packet.
+ * Returns the socket fd, or -1 (socket closed) if the interface is unknown.
+ */
+int adopt_socket(int sock, const char *nic_name, uint64_t dest_mac) {
+  fd = sock;
+  dst_mac = dest_mac;
 
   struct ifreq if_idx;
   memset(&if_idx, 0, sizeof(struct ifreq));
-  strncpy(if_idx.ifr_name, NIC_NAME, IFNAMSIZ - 1);
-  if (ioctl(fd, SIOCGIFINDEX, &if_idx) < 0)
+  strncpy(if_idx.ifr_name, nic_name, IFNAMSIZ - 1);
+  if (ioctl(fd, SIOCGIFINDEX, &if_idx) < 0) {
     perror("SIOCGIFINDEX");
+    goto fail;
+  }
   ifrindex = if_idx.ifr_ifindex;
 
   struct ifreq if_mac;
   memset(&if_mac, 0, sizeof(struct ifreq));
-  strncpy(if_mac.ifr_name, NIC_NAME, IFNAMSIZ - 1);
-  if (ioctl(fd, SIOCGIFHWADDR, &if_mac) < 0)
+  strncpy(if_mac.ifr_name, nic_name, IFNAMSIZ - 1);
+  if (ioctl(fd, SIOCGIFHWADDR, &if_mac) < 0) {
     perror("SIOCGIFHWADDR");
+    goto fail;
+  }
   memcpy(&src_mac, if_mac.ifr_hwaddr.sa_data, 6);
 
+  struct ether_header *eh = (struct ether_header *)row_eth_header;
+  encode_mac(eh->ether_dhost, dst_mac);
+  encode_mac(eh->ether_shost, src_mac);
+  eh->ether_type = htons(ROW_ETHER_TYPE);
+
+  memset(&row_address, 0, sizeof(row_address));
+  row_address.sll_ifindex = ifrindex;
+  row_address.sll_halen = ETH_ALEN;
+  encode_mac(row_address.sll_addr, dst_mac);
+
+  return fd;
+
+fail:
+  close(fd);
+  fd = -1;
+  return -1;
+}
+
+/**
+ * Open a raw AF_PACKET socket on `nic_name` and cache the interface index +
+ * MAC. Returns the socket fd, or -1 if the socket could not be created or
+ * the interface is unknown.
+ */
+int open_socket(const char *nic_name, uint64_t dest_mac) {
+  int sock = socket(AF_PACKET, SOCK_RAW, IPPROTO_RAW);
+  if (sock < 0) {
+    perror("socket");
+    return -1;
+  }
+  return adopt_socket(sock, nic_name, dest_mac);
+}
+
+/**
+ * Check that `nic_name` exists and has a hardware address, without
+ * opening a raw socket. Returns 0 if so, -1 otherwise.
+ */
+int check_interface(const char *nic_name) {
+  int probe = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (probe < 0) {
+    perror("socket");
+    return -1;
+  }
+
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(struct ifreq));
+  strncpy(ifr.ifr_name, nic_name, IFNAMSIZ - 1);
+  int ok = ioctl(probe, SIOCGIFINDEX, &ifr) == 0 && ioctl(probe, SIOCGIFHWADDR, &ifr) == 0;
+  if (!ok) fprintf(stderr, "Interface %s: %s\n", nic_name, strerror(errno));
+  close(probe);
+  return ok ? 0 : -1;
+}
+
+/** Raw socket fd, for handing over to a successor process. */
+int socket_fd(void) {
   return fd;
 }
 
@@ -103,7 +180,7 @@ static int send_socket(unsigned int ether_type, uint8_t *data, int len) {
   memset(sendbuf, 0, BUF_SIZ);
 
   encode_mac(eh->ether_shost, src_mac);    /* Source MAC (our NIC) */
-  encode_mac(eh->ether_dhost, DEST_MAC);   /* Destination MAC (FPGA receiver) */
+  encode_mac(eh->ether_dhost, dst_mac);    /* Destination MAC (FPGA receiver) */
 
   eh->ether_type = htons(ether_type);
   tx_len += sizeof(struct ether_header);
@@ -117,13 +194,21 @@ static int send_socket(unsigned int ether_type, uint8_t *data, int len) {
   /* Link-layer destination for sendto() */
   socket_address.sll_ifindex = ifrindex;
   socket_address.sll_halen = ETH_ALEN;
-  encode_mac(socket_address.sll_addr, DEST_MAC);
+  encode_mac(socket_address.sll_addr, dst_mac);
 
   ssize_t sent = sendto(fd, sendbuf, tx_len, 0,
                          (struct sockaddr *)&socket_address,
                          sizeof(struct sockaddr_ll));
-  if (sent < 0)
-    perror("sendto");
+  /* A dead link fails every packet; log the first and then every 1000th. */
+  if (sent < 0) {
+    if (metrics.send_errors % 1000 == 0)
+      fprintf(stderr, "sendto: %s (%llu errors so far)\n", strerror(errno),
+              (unsigned long long)metrics.send_errors + 1);
+    metric_add(&metrics.send_errors, 1);
+  } else {
+    metric_add(&metrics.packets_sent, 1);
+    metric_add(&metrics.bytes_sent, (uint64_t)sent);
+  }
 
   return (int)sent;
 }
@@ -156,7 +241,53 @@ int send_frame(void) {
   return send_socket(FRAME_ETHER_TYPE, frame_data, FRAME_DATA_LENGTH);
 }
 
-/** Send a single row of pixel data (EtherType 0x5500). */
-int send_row(uint8_t *data, size_t len) {
-  return send_socket(ROW_ETHER_TYPE, data, (int)len);
+/*
+ * Send a frame's row packets (EtherType 0x5500) with one sendmmsg() per
+ * batch instead of a sendto() and a 1.5 KB copy per row. Rows with
+ * Ethernet room (wire-format frames, see frame.h) go out as a single
+ * iovec straight from the buffer; converted rows go out as the shared
+ * Ethernet header plus the row. A packet the kernel refuses is counted
+ * and skipped, like a failed sendto(), and the rest are sent after it.
+ */
+int send_rows(uint8_t *rows, size_t stride, int count, size_t len, int eth_room) {
+  if (count > CONFIG_MAX_HEIGHT) count = CONFIG_MAX_HEIGHT;
+  for (int i = 0; i < count; i++) {
+    uint8_t *row = rows + (size_t)i * stride;
+    struct msghdr *msg = &row_msgs[i].msg_hdr;
+    msg->msg_name = &row_address;
+    msg->msg_namelen = sizeof(row_address);
+    msg->msg_iov = row_iovs[i];
+    msg->msg_control = NULL;
+    msg->msg_controllen = 0;
+    msg->msg_flags = 0;
+    if (eth_room) {
+      memcpy(row, row_eth_header, ETH_HEADER_SIZE);
+      row_iovs[i][0] = (struct iovec){ row, ETH_HEADER_SIZE + len };
+      msg->msg_iovlen = 1;
+    } else {
+      row_iovs[i][0] = (struct iovec){ row_eth_header, ETH_HEADER_SIZE };
+      row_iovs[i][1] = (struct iovec){ row, len };
+      msg->msg_iovlen = 2;
+    }
+  }
+
+  int sent = 0;
+  for (int i = 0; i < count;) {
+    int n = sendmmsg(fd, row_msgs + i, (unsigned int)(count - i), 0);
+    if (n <= 0) {
+      if (metrics.send_errors % 1000 == 0)
+        fprintf(stderr, "sendmmsg: %s (%llu errors so far)\n", strerror(errno),
+                (unsigned long long)metrics.send_errors + 1);
+      metric_add(&metrics.send_errors, 1);
+      i++;
+      continue;
+    }
+    uint64_t bytes = 0;
+    for (int k = 0; k < n; k++) bytes += row_msgs[i + k].msg_len;
+    metric_add(&metrics.packets_sent, (uint64_t)n);
+    metric_add(&metrics.bytes_sent, bytes);
+    sent += n;
+    i += n;
+  }
+  return sent;
 }
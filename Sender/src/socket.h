@@ -8,7 +8,8 @@
  *   EtherType 0x0107 — Frame commit (98-byte command with brightness)
  *
  * The FPGA receiver's default MAC is 11:22:33:44:55:66. All packets
- * are built and sent via AF_PACKET raw sockets on eth0.
+ * are built and sent via AF_PACKET raw sockets on eth0 (both are
+ * configurable, see config.h).
  */
 
 #ifndef SOCKET_H
@@ -19,7 +20,6 @@
 
 // ── Protocol constants ──────────────────────────────────────────────
 
-#define DEST_MAC            0x112233445566ULL  /* FPGA receiver default MAC */
 #define ROW_ETHER_TYPE      0x5500             /* EtherType for row data packets */
 #define FRAME_ETHER_TYPE    0x0107             /* EtherType for frame commit packets */
 #define FRAME_DATA_LENGTH   98                 /* Frame commit packet size (bytes) */
@@ -39,6 +39,9 @@
 // 7-byte header prepended to each row's RGB pixel data. Encodes the
 // row index, pixel count (big-endian uint16), and protocol flags.
 
+#define ROW_HEADER_SIZE 7               /* sizeof(fpga_row_header_t) */
+#define ETH_HEADER_SIZE 14              /* Destination MAC, source MAC, EtherType */
+
 typedef struct __attribute__((packed)) {
   uint8_t  row;           /* Scanline index (0-63) */
   uint8_t  reserved_hi;   /* Always 0 */
@@ -51,10 +54,21 @@ typedef struct __attribute__((packed)) {
 
 // ── Public API ──────────────────────────────────────────────────────
 
-extern int  open_socket(void);
+extern int  open_socket(const char *nic_name, uint64_t dest_mac);
+extern int  adopt_socket(int sock, const char *nic_name, uint64_t dest_mac);
+extern int  check_interface(const char *nic_name);
+extern int  socket_fd(void);
 extern void close_socket(void);
 extern int  send_frame(void);
 extern void set_brightness(int brightness);
-extern int  send_row(uint8_t *data, size_t len);
+
+/*
+ * Send `count` row packets of `len` bytes, one every `stride` bytes of
+ * `rows`, in one sendmmsg() call. With `eth_room` set each row starts
+ * with ETH_HEADER_SIZE spare bytes, which are overwritten with the
+ * Ethernet header and sent in place (`len` excludes them). Returns the
+ * number of packets sent.
+ */
+extern int  send_rows(uint8_t *rows, size_t stride, int count, size_t len, int eth_room);
 
 #endif /* SOCKET_H */
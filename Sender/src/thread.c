@@ -0,0 +1,42 @@
+/*
+ * thread.c — Background thread placement
+ *
+ * A thread inherits the affinity mask of its creator, so a helper started
+ * from the pinned frame loop would share its core. The new thread gets
+ * the complement of the caller's mask instead; if that is empty (an
+ * unpinned run, or a single-core box) the mask is left alone.
+ */
+
+#define _GNU_SOURCE
+#include "thread.h"
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// ── Public API ──────────────────────────────────────────────────────
+
+int thread_start_background(const char *name, void *(*fn)(void *), void *arg) {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  cpu_set_t mine, others;
+  CPU_ZERO(&others);
+  if (sched_getaffinity(0, sizeof(mine), &mine) == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long cpu = 0; cpu < cpus && cpu < CPU_SETSIZE; cpu++)
+      if (!CPU_ISSET(cpu, &mine)) CPU_SET(cpu, &others);
+  }
+  if (CPU_COUNT(&others) > 0) pthread_attr_setaffinity_np(&attr, sizeof(others), &others);
+
+  pthread_t thread;
+  int err = pthread_create(&thread, &attr, fn, arg);
+  pthread_attr_destroy(&attr);
+  if (err != 0) {
+    fprintf(stderr, "ERROR: cannot start %s thread: %s\n", name, strerror(err));
+    return -1;
+  }
+  pthread_setname_np(thread, name);
+  return 0;
+}
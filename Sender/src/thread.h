@@ -0,0 +1,21 @@
+/*
+ * thread.h — Helper threads that stay off the frame loop's core
+ *
+ * The frame loop owns its CPU (./start pins it with taskset). Anything
+ * else the Sender runs in the background — the control plane, for one —
+ * is started here: same process, but moved onto the remaining CPUs so it
+ * can never preempt a commit.
+ */
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <pthread.h>
+
+// ── Public API ──────────────────────────────────────────────────────
+
+/* Start a detached thread named `name` on every online CPU except the
+   caller's. Returns 0 on success. */
+extern int thread_start_background(const char *name, void *(*fn)(void *), void *arg);
+
+#endif /* THREAD_H */
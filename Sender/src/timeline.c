@@ -0,0 +1,148 @@
+/*
+ * timeline.c — Render a flight-recorder dump as a text timeline
+ *
+ *   bin/timeline /tmp/flight-20260101-120000-miss.csv [first_slot [count]]
+ *
+ * One line per slot, drawn on an axis running from one frame period
+ * before the slot's deadline to one period after it:
+ *
+ *   p  getting the frame (batch, Redis round trip, pattern)
+ *   c  conversion
+ *   s  row packets
+ *   .  waiting for the deadline
+ *   |  the deadline        *  the commit (X when late by over a period)
+ *
+ * With no range given, it prints a summary and the slots around the
+ * worst (latest-committed) slot in the dump.
+ */
+
+#include "recorder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Constants ───────────────────────────────────────────────────────
+
+#define AXIS_COLUMNS   64             /* Two frame periods */
+#define CONTEXT_SLOTS  24             /* Slots shown either side of the worst one */
+
+// ── Parsing ─────────────────────────────────────────────────────────
+
+typedef struct {
+  unsigned long long slot;
+  double start, ready, converted, sent, deadline, commit, late;  /* Microseconds */
+  int    depth, brightness;
+  char   flags[12];
+} row_t;
+
+static int parse_row(const char *line, row_t *r) {
+  r->flags[0] = '\0';
+  int n = sscanf(line, "%llu,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%d,%d,%11s",
+                 &r->slot, &r->start, &r->ready, &r->converted, &r->sent, &r->deadline,
+                 &r->commit, &r->late, &r->depth, &r->brightness, r->flags);
+  return n >= 10 ? 0 : -1;
+}
+
+// ── Rendering ───────────────────────────────────────────────────────
+
+/** Fill axis columns covering [from, to) microseconds with `c`. */
+static void paint(char *axis, double origin, double scale, double from, double to, char c) {
+  if (to <= from) return;
+  int a = (int)((from - origin) / scale);
+  int b = (int)((to - origin) / scale);
+  if (a < 0) a = 0;
+  if (b >= AXIS_COLUMNS) b = AXIS_COLUMNS - 1;
+  for (int i = a; i <= b; i++) axis[i] = c;
+}
+
+static void render(const row_t *r, double period) {
+  char axis[AXIS_COLUMNS + 1];
+  memset(axis, ' ', AXIS_COLUMNS);
+  axis[AXIS_COLUMNS] = '\0';
+
+  const double origin = r->deadline - period;
+  const double scale = 2 * period / AXIS_COLUMNS;
+  const int has_rows = strchr(r->flags, 'R') != NULL;
+  const int has_commit = strchr(r->flags, 'C') != NULL;
+
+  double ready = has_rows ? r->ready : r->sent > 0 ? r->sent : r->start;
+  paint(axis, origin, scale, r->start, ready, 'p');
+  if (has_rows) {
+    paint(axis, origin, scale, r->ready, r->converted, 'c');
+    paint(axis, origin, scale, r->converted, r->sent, 's');
+  }
+  double waited_from = has_rows ? r->sent : ready;
+  if (has_commit) paint(axis, origin, scale, waited_from, r->commit, '.');
+
+  axis[AXIS_COLUMNS / 2] = '|';
+  if (has_commit) {
+    int col = (int)((r->commit - origin) / scale);
+    if (col >= AXIS_COLUMNS) axis[AXIS_COLUMNS - 1] = 'X';
+    else if (col >= 0) axis[col] = '*';
+  }
+  if (r->start < origin) axis[0] = '<';
+
+  printf("%8llu %9.1f %5d %4d %-5s %s\n", r->slot, has_commit ? r->late : 0.0,
+         r->depth, r->brightness, r->flags, axis);
+}
+
+// ── Main ────────────────────────────────────────────────────────────
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <flight.csv> [first_slot [count]]\n", argv[0]);
+    return 1;
+  }
+  FILE *fp = fopen(argv[1], "r");
+  if (fp == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  static row_t rows[RECORDER_FRAMES];
+  char line[512];
+  int n = 0;
+  while (fgets(line, sizeof(line), fp) && n < RECORDER_FRAMES)
+    if (parse_row(line, &rows[n]) == 0) n++;   /* Skips the header */
+  fclose(fp);
+  if (n < 2) {
+    fprintf(stderr, "%s: no records\n", argv[1]);
+    return 1;
+  }
+
+  /* Frame period: the most common deadline step (reloads may change it). */
+  double period = rows[1].deadline - rows[0].deadline;
+  int commits = 0, late = 0, worst = -1;
+  for (int i = 0; i < n; i++) {
+    if (i > 0) {
+      double step = rows[i].deadline - rows[i - 1].deadline;
+      if (step > 0 && step < period) period = step;
+    }
+    if (!strchr(rows[i].flags, 'C')) continue;
+    commits++;
+    if (rows[i].late > 1000) late++;
+    if (worst < 0 || rows[i].late > rows[worst].late) worst = i;
+  }
+
+  int first = 0, count = n;
+  if (argc > 2) {
+    unsigned long long want = strtoull(argv[2], NULL, 10);
+    while (first < n && rows[first].slot < want) first++;
+    count = argc > 3 ? atoi(argv[3]) : n - first;
+  } else if (worst >= 0) {
+    first = worst > CONTEXT_SLOTS ? worst - CONTEXT_SLOTS : 0;
+    count = 2 * CONTEXT_SLOTS + 1;
+  }
+
+  printf("%d slots, %d commits, %d more than 1 ms late, period %.1f us", n, commits, late, period);
+  if (worst >= 0) printf(", worst commit %.1f us late (slot %llu)", rows[worst].late, rows[worst].slot);
+  char ruler[AXIS_COLUMNS + 1];
+  memset(ruler, ' ', AXIS_COLUMNS);
+  ruler[AXIS_COLUMNS] = '\0';
+  memcpy(ruler, "-T", 2);
+  memcpy(ruler + AXIS_COLUMNS / 2, "|deadline", 9);
+  memcpy(ruler + AXIS_COLUMNS - 2, "+T", 2);
+  printf("\n\n%8s %9s %5s %4s %-5s %s\n", "slot", "late_us", "depth", "brt", "flags", ruler);
+  for (int i = first; i < n && i < first + count; i++) render(&rows[i], period);
+  return 0;
+}
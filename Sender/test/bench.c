@@ -0,0 +1,160 @@
+/*
+ * bench.c — Per-frame cost of the Sender's pixel kernels
+ *
+ *   make bench
+ *
+ * Times each kernel on a hot, in-cache 320x64 frame: the median of a
+ * few hundred runs after a warm-up. In the running Sender the inputs
+ * are often cold (a fresh Redis reply), so the pts and stats lines read
+ * higher; these numbers are for comparing builds and kernels.
+ */
+
+#include "../src/blend.h"
+#include "../src/convert.h"
+#include "../src/socket.h"
+#include "fixtures.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ── Harness ─────────────────────────────────────────────────────────
+
+#define CANVAS_WIDTH   320
+#define CANVAS_HEIGHT  64
+#define CANVAS_BYTES   (CANVAS_WIDTH * CANVAS_HEIGHT * 4)
+#define WARMUP         50
+#define RUNS           501
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* Median microseconds per call of fn(ctx) */
+static double time_us(void (*fn)(void *), void *ctx) {
+  static double runs[RUNS];
+  for (int i = 0; i < WARMUP; i++) fn(ctx);
+  for (int i = 0; i < RUNS; i++) {
+    const double start = now_us();
+    fn(ctx);
+    runs[i] = now_us() - start;
+  }
+  qsort(runs, RUNS, sizeof runs[0], compare_double);
+  return runs[RUNS / 2];
+}
+
+static void report(const char *name, double us) {
+  printf("  %-34s %7.1f us/frame\n", name, us);
+}
+
+static void fill_random(uint8_t *buf, size_t len) {
+  uint32_t s = 0x9E3779B9;
+  for (size_t i = 0; i < len; i++) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    buf[i] = (uint8_t)s;
+  }
+}
+
+// ── Blend ───────────────────────────────────────────────────────────
+
+static uint8_t key_a[CANVAS_BYTES], key_b[CANVAS_BYTES], blended[CANVAS_BYTES];
+
+static void run_blend(void *ctx) {
+  (void)ctx;
+  blend_frames(key_a, key_b, blended, CANVAS_BYTES, 97);
+}
+
+/* The same formula as a plain loop, left to the autovectoriser */
+static void __attribute__((noinline)) run_blend_scalar(void *ctx) {
+  (void)ctx;
+  for (size_t i = 0; i < CANVAS_BYTES; i++)
+    blended[i] = (uint8_t)((key_a[i] * (BLEND_ONE - 97) + key_b[i] * 97 + BLEND_ONE / 2) >> 8);
+}
+
+static void bench_blend(void) {
+  fill_random(key_a, sizeof key_a);
+  fill_random(key_b, sizeof key_b);
+  printf("blend, %dx%d BGRA:\n", CANVAS_WIDTH, CANVAS_HEIGHT);
+  report("blend_frames", time_us(run_blend, NULL));
+  report("scalar loop (autovectorised)", time_us(run_blend_scalar, NULL));
+}
+
+// ── Conversion ──────────────────────────────────────────────────────
+
+static uint8_t canvas[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH * 4];
+static uint8_t rows[CONFIG_MAX_HEIGHT * (ROW_HEADER_SIZE + CONFIG_MAX_WIDTH * 3)];
+
+typedef struct {
+  int width, height;                         /* Sign */
+  int src_width, src_height;                 /* Canvas handed to convert_frame() */
+} convert_run_t;
+
+static void run_convert(void *ctx) {
+  const convert_run_t *r = ctx;
+  convert_frame(canvas, r->src_width, r->src_height, rows,
+                ROW_HEADER_SIZE + (size_t)r->width * 3, r->width, r->height);
+}
+
+/* Prepare `cfg`, convert a random `src_width` x `src_height` canvas, report it as `name`. */
+static void bench_convert(const char *name, const sender_config_t *cfg, int src_width, int src_height) {
+  convert_run_t run = { cfg->sign_width, cfg->sign_height, src_width, src_height };
+  convert_prepare(cfg);
+  fill_random(canvas, (size_t)src_width * src_height * 4);
+  report(name, time_us(run_convert, &run));
+}
+
+static void bench_ccm(void) {
+  sender_config_t cfg;
+  printf("convert, 320x64 -> RGB rows:\n");
+  config_defaults(&cfg);
+  bench_convert("plain", &cfg, 320, 64);
+  fixture_ccm_full(&cfg);
+  bench_convert("full-frame ccm", &cfg, 320, 64);
+  fixture_ccm_patchwork(&cfg);
+  bench_convert("five overlapping ccm regions", &cfg, 320, 64);
+}
+
+static void bench_remap(void) {
+  sender_config_t cfg;
+  printf("convert, 320x64 remapped:\n");
+  config_defaults(&cfg);
+  bench_convert("identity", &cfg, 320, 64);
+  fixture_panels_mixed(&cfg);
+  bench_convert("20 panels, mixed rotation/flip", &cfg, 320, 64);
+  fixture_ccm_full(&cfg);
+  bench_convert("identity + full-frame ccm", &cfg, 320, 64);
+  fixture_panels_mixed(&cfg);
+  fixture_add_ccm(&cfg, 0, 0, cfg.sign_width, cfg.sign_height, FIXTURE_WARM);
+  bench_convert("mixed + full-frame ccm", &cfg, 320, 64);
+  fixture_panels_strips(&cfg);
+  bench_convert("turned panels under 16 ccm strips", &cfg, 320, 64);
+}
+
+static void bench_scaled(void) {
+  sender_config_t cfg;
+  printf("convert, upscaled to 320x64:\n");
+  config_defaults(&cfg);
+  bench_convert("160x32 plain", &cfg, 160, 32);
+  bench_convert("213x43 plain (non-integer)", &cfg, 213, 43);
+  fixture_ccm_full(&cfg);
+  bench_convert("160x32 full-frame ccm", &cfg, 160, 32);
+  fixture_panels_mixed(&cfg);
+  bench_convert("160x32 mixed panels", &cfg, 160, 32);
+}
+
+// ── Main ────────────────────────────────────────────────────────────
+
+int main(void) {
+  bench_blend();
+  bench_ccm();
+  bench_remap();
+  bench_scaled();
+  return 0;
+}
@@ -0,0 +1,491 @@
+/*
+ * check.c — Reference checks for the Sender's pixel kernels
+ *
+ *   make test
+ *
+ * Each vectorised kernel is run against a plain scalar model of what it
+ * is meant to compute, on synthetic inputs, and must match byte for
+ * byte. The interpolation check also renders synthetic scenes at a true
+ * 240 FPS and reports how close blending keyframes gets to them compared
+ * with holding the last keyframe. Exits non-zero on the first mismatch.
+ */
+
+#include "../src/blend.h"
+#include "../src/convert.h"
+#include "../src/socket.h"
+#include "fixtures.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Harness ─────────────────────────────────────────────────────────
+
+#define CANVAS_WIDTH   320
+#define CANVAS_HEIGHT  64
+#define CANVAS_BYTES   (CANVAS_WIDTH * CANVAS_HEIGHT * 4)
+
+static int failures;
+
+static void __attribute__((format(printf, 2, 3))) fail(const char *check, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  printf("FAIL %s: ", check);
+  vprintf(fmt, ap);
+  printf("\n");
+  va_end(ap);
+  failures++;
+}
+
+/* xorshift32: the same inputs on every run and every machine */
+static uint32_t rng_state = 0x9E3779B9;
+
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static void fill_random(uint8_t *buf, size_t len) {
+  for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)rng();
+}
+
+// ── Blend ───────────────────────────────────────────────────────────
+
+static uint8_t blend_ref(uint8_t a, uint8_t b, int weight) {
+  return (uint8_t)((a * (BLEND_ONE - weight) + b * weight + BLEND_ONE / 2) >> 8);
+}
+
+/* Every weight, every length up to a few vector steps, unaligned starts. */
+static void check_blend_exact(void) {
+  enum { MAX_LEN = 130, OFFSETS = 4 };
+  uint8_t a[MAX_LEN + OFFSETS], b[MAX_LEN + OFFSETS], out[MAX_LEN + OFFSETS + 1];
+  int cases = 0;
+
+  for (int weight = 0; weight <= BLEND_ONE; weight++) {
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+      const size_t off = len % OFFSETS;
+      fill_random(a, sizeof a);
+      fill_random(b, sizeof b);
+      /* Extremes in the first bytes: 255/0 pairs are where rounding overflows */
+      if (len >= 4) { a[off] = 255; b[off] = 255; a[off + 1] = 255; b[off + 1] = 0;
+                      a[off + 2] = 0; b[off + 2] = 255; a[off + 3] = 0; b[off + 3] = 0; }
+      memset(out, 0xA5, sizeof out);
+      blend_frames(a + off, b + off, out + off, len, weight);
+      for (size_t i = 0; i < len; i++) {
+        const uint8_t want = blend_ref(a[off + i], b[off + i], weight);
+        if (out[off + i] != want) {
+          fail("blend exact", "weight %d len %zu byte %zu: got %u, want %u",
+               weight, len, i, out[off + i], want);
+          return;
+        }
+      }
+      if (out[off + len] != 0xA5) {
+        fail("blend exact", "weight %d len %zu: wrote past the end", weight, len);
+        return;
+      }
+      cases++;
+    }
+  }
+
+  /* A whole canvas, so the vector loop runs long */
+  static uint8_t fa[CANVAS_BYTES], fb[CANVAS_BYTES], fo[CANVAS_BYTES];
+  fill_random(fa, sizeof fa);
+  fill_random(fb, sizeof fb);
+  for (int weight = 0; weight <= BLEND_ONE; weight += 17) {
+    blend_frames(fa, fb, fo, sizeof fo, weight);
+    for (size_t i = 0; i < sizeof fo; i++)
+      if (fo[i] != blend_ref(fa[i], fb[i], weight)) {
+        fail("blend exact", "canvas weight %d byte %zu", weight, i);
+        return;
+      }
+    cases++;
+  }
+  printf("ok   blend exact: %d cases, weights 0..%d, lengths 0..%d\n", cases, BLEND_ONE, MAX_LEN);
+}
+
+// ── Interpolation visual diff ───────────────────────────────────────
+
+/*
+ * Synthetic scenes, rendered at any time t (seconds) with coverage-based
+ * anti-aliasing, so a 240 FPS render is the ground truth the panel would
+ * show if the movie were rendered at full rate.
+ */
+typedef void (*scene_fn)(double t, uint8_t *bgra);
+
+static void put(uint8_t *bgra, int x, int y, double r, double g, double b) {
+  uint8_t *p = bgra + ((size_t)y * CANVAS_WIDTH + x) * 4;
+  p[0] = (uint8_t)lround(b);
+  p[1] = (uint8_t)lround(g);
+  p[2] = (uint8_t)lround(r);
+  p[3] = 255;
+}
+
+/* How much of the unit interval [x, x + 1) lies inside [left, right) */
+static double coverage(int x, double left, double right) {
+  const double lo = x > left ? x : left;
+  const double hi = x + 1 < right ? x + 1 : right;
+  return hi > lo ? hi - lo : 0;
+}
+
+/* A colour gradient fading in from black over one second */
+static void scene_fade(double t, uint8_t *bgra) {
+  const double level = t < 1 ? t : 1;
+  for (int y = 0; y < CANVAS_HEIGHT; y++)
+    for (int x = 0; x < CANVAS_WIDTH; x++)
+      put(bgra, x, y, level * (255.0 * x / (CANVAS_WIDTH - 1)),
+          level * (255.0 * y / (CANVAS_HEIGHT - 1)), level * 160);
+}
+
+/* Blocky "glyphs" 8 px apart scrolling left at 100 px/s, white on black */
+static void scene_ticker(double t, uint8_t *bgra) {
+  static uint8_t glyphs[64];          /* One 5x8 glyph column mask per cell, repeated */
+  if (!glyphs[0]) for (int i = 0; i < 64; i++) glyphs[i] = (uint8_t)(0x81 | (i * 37 + 11));
+  const double shift = 100 * t;
+
+  for (int y = 0; y < CANVAS_HEIGHT; y++) {
+    const int band = y / 8 == 3 || y / 8 == 4;   /* Text sits in rows 24..39 */
+    for (int x = 0; x < CANVAS_WIDTH; x++) {
+      double lit = 0;
+      if (band) {
+        /* Canvas x covers text positions [x + shift, x + shift + 1) */
+        const double u = x + shift;
+        for (int col = (int)floor(u) - 1; col <= (int)floor(u) + 1; col++) {
+          const int cell = ((col % 512) + 512) % 512;
+          const int on = cell % 8 < 5 && (glyphs[(cell / 8) % 64] >> ((y - 24) / 2 % 8)) & 1;
+          if (on) lit += coverage(col, u, u + 1);
+        }
+      }
+      put(bgra, x, y, 255 * lit, 255 * lit, 255 * lit);
+    }
+  }
+}
+
+/* A red panel sliding in from the right edge, easing out over half a second */
+static void scene_slide(double t, uint8_t *bgra) {
+  const double p = t < 0.5 ? t / 0.5 : 1;
+  const double left = CANVAS_WIDTH - (1 - (1 - p) * (1 - p) * (1 - p)) * 200;
+  for (int y = 0; y < CANVAS_HEIGHT; y++)
+    for (int x = 0; x < CANVAS_WIDTH; x++) {
+      const double c = coverage(x, left, CANVAS_WIDTH + 1);
+      put(bgra, x, y, 30 + c * 200, 30 + c * 10, 60 - c * 40);
+    }
+}
+
+static double psnr(double sq_err, double samples) {
+  return sq_err > 0 ? 10 * log10(255.0 * 255.0 * samples / sq_err) : INFINITY;
+}
+
+static double sq_diff(const uint8_t *a, const uint8_t *b) {
+  double sum = 0;
+  for (size_t i = 0; i < CANVAS_BYTES; i += 4)
+    for (int c = 0; c < 3; c++) {               /* Alpha is always 255 */
+      const double d = (double)a[i + c] - b[i + c];
+      sum += d * d;
+    }
+  return sum;
+}
+
+/*
+ * One second of `scene` at `fps` keyframes, shown on 240 Hz slots. Each
+ * in-between slot either holds the last keyframe or blends towards the
+ * next one with the weight sender.c computes; both are compared with the
+ * true render at the slot's time.
+ */
+static void visual_diff(scene_fn scene, int fps, double *hold_db, double *blend_db) {
+  static uint8_t prev[CANVAS_BYTES], next[CANVAS_BYTES], truth[CANVAS_BYTES], mixed[CANVAS_BYTES];
+  const int64_t slot_ns = 1000000000 / 240;
+  const int64_t gap_ns = 1000000000 / fps;
+  double hold_err = 0, blend_err = 0, samples = 0;
+
+  for (int k = 0; k < fps; k++) {
+    const int64_t pts_ns = k * gap_ns;
+    scene(pts_ns / 1e9, prev);
+    scene((pts_ns + gap_ns) / 1e9, next);
+    for (int64_t commit_ns = pts_ns + slot_ns; commit_ns < pts_ns + gap_ns - slot_ns / 2; commit_ns += slot_ns) {
+      int64_t weight = (commit_ns - pts_ns) * BLEND_ONE / gap_ns;
+      if (weight >= BLEND_ONE) weight = BLEND_ONE - 1;
+      scene(commit_ns / 1e9, truth);
+      blend_frames(prev, next, mixed, CANVAS_BYTES, (int)weight);
+      hold_err += sq_diff(prev, truth);
+      blend_err += sq_diff(mixed, truth);
+      samples += CANVAS_WIDTH * CANVAS_HEIGHT * 3;
+    }
+  }
+  *hold_db = psnr(hold_err, samples);
+  *blend_db = psnr(blend_err, samples);
+}
+
+static void check_blend_visual(void) {
+  const int failed = failures;
+  static const struct { const char *name; scene_fn scene; int fps; } cases[] = {
+    { "fade",     scene_fade,   60 },
+    { "fade",     scene_fade,  120 },
+    { "ticker",   scene_ticker, 60 },
+    { "ticker",   scene_ticker,120 },
+    { "slide-in", scene_slide,  60 },
+    { "slide-in", scene_slide, 120 },
+  };
+
+  printf("     blend visual diff, PSNR over in-between slots vs a true 240 FPS render:\n");
+  printf("                         hold keyframe   blend\n");
+  for (size_t i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+    double hold, blend;
+    visual_diff(cases[i].scene, cases[i].fps, &hold, &blend);
+    printf("       %-10s %3d fps   %6.1f dB       %6.1f dB\n", cases[i].name, cases[i].fps, hold, blend);
+    if (blend < hold)
+      fail("blend visual", "%s at %d fps: blending is further from the truth than holding",
+           cases[i].name, cases[i].fps);
+  }
+  if (failures == failed) printf("ok   blend visual diff\n");
+}
+
+// ── Conversion ──────────────────────────────────────────────────────
+
+#define ROW_PAD 5                              /* Bytes after each row that must stay untouched */
+#define PAD_BYTE 0x5A
+
+/*
+ * Canvas pixel shown by wire pixel (wx, wy), following panel_layout_t
+ * step by step: find the slot and its chain position, flip in panel
+ * space, then turn clockwise a quarter at a time.
+ */
+static void ref_canvas_xy(const sender_config_t *cfg, int wx, int wy, int *cx, int *cy) {
+  if (cfg->panel_count == 0) {
+    *cx = wx;
+    *cy = wy;
+    return;
+  }
+  int w = cfg->panel_width, h = cfg->panel_height;
+  const int slots_per_row = cfg->sign_width / w;
+  const int slot_row = wy / h;
+  int slot_col = wx / w;
+  if (cfg->serpentine && slot_row % 2 == 1) slot_col = slots_per_row - 1 - slot_col;
+  const panel_layout_t *p = &cfg->panels[slot_row * slots_per_row + slot_col];
+
+  int u = wx % w, v = wy % h;
+  if (p->flip == FLIP_H) u = w - 1 - u;
+  if (p->flip == FLIP_V) v = h - 1 - v;
+  for (int turn = 0; turn < p->rotation / 90; turn++) {
+    const int nu = h - 1 - v, nv = u;         /* (u, v) in w x h → (h - 1 - v, u) in h x w */
+    u = nu; v = nv;
+    const int t = w; w = h; h = t;
+  }
+  *cx = p->x + u;
+  *cy = p->y + v;
+}
+
+/* Round-half-up division by CCM_ONE, written out rather than as a shift */
+static int ref_q8(int32_t sum) {
+  return (int)floor((sum + CCM_ONE / 2) / (double)CCM_ONE);
+}
+
+/* out = M x (R, G, B) in Q8, clamped per channel, as sender.conf describes it */
+static void ref_ccm(const int32_t m[9], const uint8_t in[3], uint8_t out[3]) {
+  for (int c = 0; c < 3; c++) {
+    int v = ref_q8(m[c * 3] * in[0] + m[c * 3 + 1] * in[1] + m[c * 3 + 2] * in[2]);
+    out[c] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+  }
+}
+
+/*
+ * What convert_frame() should produce, one wire pixel at a time: find
+ * the canvas pixel, take the last ccm region containing it, and apply
+ * that matrix (or none) to its RGB.
+ */
+static void ref_convert(const sender_config_t *cfg, const uint8_t *bgra, uint8_t *rows, size_t stride) {
+  const int width = cfg->sign_width;
+
+  for (int wy = 0; wy < cfg->sign_height; wy++) {
+    uint8_t *row = rows + wy * stride;
+    const uint8_t header[ROW_HEADER_SIZE] = { (uint8_t)wy, 0, 0, (uint8_t)(width >> 8),
+                                              (uint8_t)width, 0x08, 0x88 };
+    memcpy(row, header, sizeof header);
+    memset(row + ROW_HEADER_SIZE + width * 3, PAD_BYTE, ROW_PAD);
+
+    for (int wx = 0; wx < width; wx++) {
+      int cx, cy;
+      ref_canvas_xy(cfg, wx, wy, &cx, &cy);
+      const uint8_t *px = bgra + ((size_t)cy * width + cx) * 4;
+      const uint8_t rgb[3] = { px[2], px[1], px[0] };
+      const ccm_region_t *owner = NULL;
+      for (int i = 0; i < cfg->ccm_count; i++) {
+        const ccm_region_t *r = &cfg->ccm[i];
+        if (cx >= r->x && cx < r->x + r->w && cy >= r->y && cy < r->y + r->h) owner = r;
+      }
+      uint8_t *out = row + ROW_HEADER_SIZE + wx * 3;
+      if (owner) ref_ccm(owner->m, rgb, out);
+      else memcpy(out, rgb, 3);
+    }
+  }
+}
+
+/* Nearest-neighbour upscale of a `src_width` x `src_height` canvas to the sign's size */
+static void ref_upscale(const sender_config_t *cfg, const uint8_t *src, int src_width, int src_height,
+                        uint8_t *bgra) {
+  for (int y = 0; y < cfg->sign_height; y++)
+    for (int x = 0; x < cfg->sign_width; x++) {
+      const int sx = x * src_width / cfg->sign_width, sy = y * src_height / cfg->sign_height;
+      memcpy(bgra + ((size_t)y * cfg->sign_width + x) * 4, src + ((size_t)sy * src_width + sx) * 4, 4);
+    }
+}
+
+/*
+ * Convert a `src_width` x `src_height` canvas with the prepared config
+ * and compare every row byte with upscaling it to the sign's size first
+ * and running the reference on that.
+ */
+static int compare_convert(const char *check, const sender_config_t *cfg, const uint8_t *bgra,
+                           int src_width, int src_height) {
+  static uint8_t got[CONFIG_MAX_HEIGHT * (ROW_HEADER_SIZE + CONFIG_MAX_WIDTH * 3 + ROW_PAD)];
+  static uint8_t want[sizeof got];
+  static uint8_t upscaled[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH * 4];
+  const int width = cfg->sign_width, height = cfg->sign_height;
+  const size_t stride = ROW_HEADER_SIZE + (size_t)width * 3 + ROW_PAD;
+
+  memset(got, PAD_BYTE, sizeof got);
+  convert_frame(bgra, src_width, src_height, got, stride, width, height);
+  ref_upscale(cfg, bgra, src_width, src_height, upscaled);
+  ref_convert(cfg, upscaled, want, stride);
+
+  for (int row = 0; row < height; row++)
+    for (size_t i = 0; i < stride; i++)
+      if (got[row * stride + i] != want[row * stride + i]) {
+        const long x = ((long)i - ROW_HEADER_SIZE) / 3;
+        fail(check, "row %d byte %zu (wire x %ld): got %u, want %u", row, i,
+             i < ROW_HEADER_SIZE ? -1 : x, got[row * stride + i], want[row * stride + i]);
+        return -1;
+      }
+  return 0;
+}
+
+/* Random pixels, with the all-0 / all-255 corners of the colour cube in the first row */
+static void fill_canvas(uint8_t *bgra, int width, int height) {
+  fill_random(bgra, (size_t)width * height * 4);
+  for (int i = 0; i < 8 && i < width; i++) {
+    bgra[i * 4 + 0] = i & 1 ? 255 : 0;
+    bgra[i * 4 + 1] = i & 2 ? 255 : 0;
+    bgra[i * 4 + 2] = i & 4 ? 255 : 0;
+  }
+}
+
+static void check_ccm(void) {
+  static const struct { const char *name; void (*build)(sender_config_t *); } cases[] = {
+    { "none",      config_defaults },
+    { "full",      fixture_ccm_full },
+    { "patchwork", fixture_ccm_patchwork },
+  };
+  static uint8_t canvas[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH * 4];
+  sender_config_t cfg;
+
+  for (size_t i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+    cases[i].build(&cfg);
+    convert_prepare(&cfg);
+    for (int frame = 0; frame < 4; frame++) {
+      fill_canvas(canvas, cfg.sign_width, cfg.sign_height);
+      if (compare_convert("ccm", &cfg, canvas, cfg.sign_width, cfg.sign_height) < 0) {
+        printf("     (ccm %s, frame %d)\n", cases[i].name, frame);
+        return;
+      }
+    }
+  }
+  printf("ok   ccm: plain, full-frame and overlapping regions match the scalar matrix\n");
+}
+
+static void check_remap(void) {
+  static const struct { const char *name; void (*build)(sender_config_t *); int ccm; } cases[] = {
+    { "mixed",    fixture_panels_mixed,    0 },
+    { "mixed",    fixture_panels_mixed,    1 },
+    { "portrait", fixture_panels_portrait, 0 },
+    { "portrait", fixture_panels_portrait, 1 },
+    { "strips",   fixture_panels_strips,   0 },
+  };
+  static uint8_t canvas[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH * 4];
+  static uint8_t shown[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH];
+  sender_config_t cfg;
+
+  for (size_t i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+    cases[i].build(&cfg);
+    if (cases[i].ccm) fixture_add_patchwork(&cfg);
+
+    /* The fixture itself must show every canvas pixel exactly once */
+    memset(shown, 0, sizeof shown);
+    for (int wy = 0; wy < cfg.sign_height; wy++)
+      for (int wx = 0; wx < cfg.sign_width; wx++) {
+        int cx, cy;
+        ref_canvas_xy(&cfg, wx, wy, &cx, &cy);
+        if (cx < 0 || cx >= cfg.sign_width || cy < 0 || cy >= cfg.sign_height ||
+            shown[cy * cfg.sign_width + cx]++) {
+          fail("remap", "%s: fixture shows canvas (%d, %d) twice or off-canvas", cases[i].name, cx, cy);
+          return;
+        }
+      }
+
+    convert_prepare(&cfg);
+    for (int frame = 0; frame < 4; frame++) {
+      fill_canvas(canvas, cfg.sign_width, cfg.sign_height);
+      if (compare_convert("remap", &cfg, canvas, cfg.sign_width, cfg.sign_height) < 0) {
+        printf("     (layout %s%s, frame %d)\n", cases[i].name, cases[i].ccm ? " + ccm" : "", frame);
+        return;
+      }
+    }
+  }
+  printf("ok   remap: serpentine, every rotation and flip, non-square panels, with and without ccm\n");
+}
+
+/*
+ * Canvases below the sign's size, integer and not, on each layout. The
+ * sizes run back to back without a convert_prepare() in between, so the
+ * scale table is rebuilt on every size change and a full-size frame
+ * between two scaled ones must leave it alone.
+ */
+static void check_scaled(void) {
+  static const struct { const char *name; void (*build)(sender_config_t *); int ccm; } layouts[] = {
+    { "identity",  config_defaults,         0 },
+    { "identity",  config_defaults,         1 },
+    { "mixed",     fixture_panels_mixed,    0 },
+    { "mixed",     fixture_panels_mixed,    1 },
+    { "portrait",  fixture_panels_portrait, 1 },
+    { "strips",    fixture_panels_strips,   0 },
+  };
+  static const int sizes[][2] = {
+    { 160, 32 }, { 80, 16 }, { 213, 43 }, { 320, 37 }, { 101, 64 }, { 1, 1 },
+    { 319, 63 }, { 320, 64 }, { 160, 32 },
+  };
+  static uint8_t canvas[CONFIG_MAX_HEIGHT * CONFIG_MAX_WIDTH * 4];
+  sender_config_t cfg;
+
+  for (size_t i = 0; i < sizeof layouts / sizeof layouts[0]; i++) {
+    layouts[i].build(&cfg);
+    if (layouts[i].ccm) fixture_add_patchwork(&cfg);
+    convert_prepare(&cfg);
+    for (size_t s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+      fill_canvas(canvas, sizes[s][0], sizes[s][1]);
+      if (compare_convert("scaled", &cfg, canvas, sizes[s][0], sizes[s][1]) < 0) {
+        printf("     (layout %s%s, source %dx%d)\n", layouts[i].name, layouts[i].ccm ? " + ccm" : "",
+               sizes[s][0], sizes[s][1]);
+        return;
+      }
+    }
+  }
+  printf("ok   scaled: integer and non-integer factors on plain, ccm and remapped layouts match upscale-then-convert\n");
+}
+
+// ── Main ────────────────────────────────────────────────────────────
+
+int main(void) {
+  check_blend_exact();
+  check_blend_visual();
+  check_ccm();
+  check_remap();
+  check_scaled();
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
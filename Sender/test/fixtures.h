@@ -0,0 +1,98 @@
+/*
+ * fixtures.h — Sign configurations shared by check.c and bench.c
+ *
+ * Each fixture starts from config_defaults() (320x64, no colour
+ * correction, identity layout) and sets only what the case is about,
+ * the way the matching sender.conf lines would.
+ */
+
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include "../src/config.h"
+
+// ── Colour correction ───────────────────────────────────────────────
+
+static inline void fixture_add_ccm(sender_config_t *cfg, int x, int y, int w, int h,
+                                   const int32_t m[9]) {
+  ccm_region_t *r = &cfg->ccm[cfg->ccm_count++];
+  r->x = x; r->y = y; r->w = w; r->h = h;
+  for (int i = 0; i < 9; i++) r->m[i] = m[i];
+}
+
+/* A warm panel batch pulled towards neutral: negative terms and gains over 1.0 clamp */
+static const int32_t FIXTURE_WARM[9] = { 230, -20, 10,  -8, 270, -6,  12, -30, 300 };
+static const int32_t FIXTURE_COOL[9] = { 280, 15, -40,  0, 250, 0,  -25, 10, 215 };
+static const int32_t FIXTURE_SWAP[9] = { 0, 0, 256,  0, 256, 0,  256, 0, 0 };
+
+/* One matrix over the whole canvas: every pixel takes the vector path */
+static inline void fixture_ccm_full(sender_config_t *cfg) {
+  config_defaults(cfg);
+  fixture_add_ccm(cfg, 0, 0, cfg->sign_width, cfg->sign_height, FIXTURE_WARM);
+}
+
+/*
+ * Overlapping regions at odd offsets and widths, so spans start and end
+ * mid-vector, later regions cut into earlier ones and some pixels stay
+ * plain.
+ */
+static inline void fixture_add_patchwork(sender_config_t *cfg) {
+  fixture_add_ccm(cfg, 0, 0, 160, 64, FIXTURE_WARM);
+  fixture_add_ccm(cfg, 157, 3, 101, 40, FIXTURE_COOL);
+  fixture_add_ccm(cfg, 1, 1, 3, 61, FIXTURE_SWAP);
+  fixture_add_ccm(cfg, 200, 30, 119, 34, FIXTURE_SWAP);
+  fixture_add_ccm(cfg, 50, 10, 1, 1, FIXTURE_COOL);
+}
+
+static inline void fixture_ccm_patchwork(sender_config_t *cfg) {
+  config_defaults(cfg);
+  fixture_add_patchwork(cfg);
+}
+
+// ── Panel layouts ───────────────────────────────────────────────────
+
+static inline void fixture_add_panel(sender_config_t *cfg, int x, int y, int rotation,
+                                     panel_flip_t flip) {
+  panel_layout_t *p = &cfg->panels[cfg->panel_count++];
+  p->x = x; p->y = y; p->rotation = rotation; p->flip = flip;
+}
+
+/*
+ * Twenty 32x32 panels, serpentine, every rotation and flip, each slot
+ * showing a canvas tile other than the one in its own position.
+ */
+static inline void fixture_panels_mixed(sender_config_t *cfg) {
+  config_defaults(cfg);
+  cfg->panel_width = cfg->panel_height = 32;
+  cfg->serpentine = 1;
+  for (int slot = 0; slot < 20; slot++) {
+    const int tile = (slot * 7 + 3) % 20;
+    fixture_add_panel(cfg, tile % 10 * 32, tile / 10 * 32, slot % 4 * 90, (panel_flip_t)(slot % 3));
+  }
+}
+
+/* Ten 64x32 panels mounted on end (90 or 270), each covering a 32x64 canvas column */
+static inline void fixture_panels_portrait(sender_config_t *cfg) {
+  config_defaults(cfg);
+  cfg->panel_width = 64;
+  cfg->panel_height = 32;
+  cfg->serpentine = 1;
+  for (int slot = 0; slot < 10; slot++)
+    fixture_add_panel(cfg, (9 - slot) * 32, 0, slot & 1 ? 270 : 90, (panel_flip_t)(slot % 3));
+}
+
+/*
+ * Twenty panels turned 90 under sixteen 4-row ccm strips: a wire row
+ * changes region every four pixels, the most spans a row has needed.
+ */
+static inline void fixture_panels_strips(sender_config_t *cfg) {
+  static const int32_t identity[9] = { CCM_ONE, 0, 0,  0, CCM_ONE, 0,  0, 0, CCM_ONE };
+  config_defaults(cfg);
+  cfg->panel_width = cfg->panel_height = 32;
+  for (int slot = 0; slot < 20; slot++)
+    fixture_add_panel(cfg, slot % 10 * 32, slot / 10 * 32, 90, FLIP_NONE);
+  for (int i = 0; i < 16; i++)
+    fixture_add_ccm(cfg, 0, i * 4, cfg->sign_width, 4, i & 1 ? FIXTURE_COOL : identity);
+}
+
+#endif /* FIXTURES_H */